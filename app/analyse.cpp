@@ -0,0 +1,175 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "analyse.h"
+#include "search.h"
+#include "tt.h"
+
+namespace loltaxx::analyse {
+
+namespace {
+
+// EPD lines carry operations after the position, which are dropped along with blank and comment
+// lines
+std::vector<std::string> read_positions(std::istream& input) {
+    std::vector<std::string> fens;
+    std::string line;
+    while (std::getline(input, line)) {
+        line = line.substr(0, line.find(';'));
+        std::size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') {
+            continue;
+        }
+        std::size_t end = line.find_last_not_of(" \t\r");
+        fens.push_back(line.substr(begin, end - begin + 1));
+    }
+    return fens;
+}
+
+std::string json_string(const std::string& str) {
+    std::string json = "\"";
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            json += '\\';
+        }
+        json += c;
+    }
+    return json + "\"";
+}
+
+std::string result_line(const std::string& fen,
+                        std::optional<Move> best_move,
+                        const search::SearchGlobals& search_globals,
+                        std::uint64_t time_ms) {
+    std::ostringstream line;
+    line << "{\"fen\": " << json_string(fen) << ", \"bestmove\": \""
+         << (best_move ? best_move->to_str() : "0000") << "\", \"score\": "
+         << search_globals.score() << ", \"pv\": [";
+    const MoveList& pv = search_globals.pv();
+    for (int i = 0; i < pv.size(); ++i) {
+        line << (i ? ", \"" : "\"") << pv[i] << '"';
+    }
+    line << "], \"nodes\": " << search_globals.nodes() << ", \"time_ms\": " << time_ms << "}\n";
+    return line.str();
+}
+
+// Lines finished out of turn wait here until those before them are written, unless they are
+// written as they finish
+class ResultWriter {
+   public:
+    ResultWriter(std::ostream* output, std::size_t num_lines, bool completion_order)
+        : output_(output), completion_order_(completion_order), pending_(num_lines) {
+    }
+
+    void write(std::size_t index, std::string line) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (completion_order_) {
+            *output_ << line << std::flush;
+            return;
+        }
+        pending_[index] = std::move(line);
+        bool wrote = false;
+        while (next_ < pending_.size() && pending_[next_]) {
+            *output_ << *pending_[next_];
+            pending_[next_++].reset();
+            wrote = true;
+        }
+        if (wrote) {
+            output_->flush();
+        }
+    }
+
+   private:
+    std::ostream* output_;
+    bool completion_order_;
+    std::mutex mutex_;
+    std::vector<std::optional<std::string>> pending_;
+    std::size_t next_ = 0;
+};
+
+}  // namespace
+
+int analyse(const AnalyseOptions& options) {
+    std::ifstream input_file{options.input};
+    if (!input_file) {
+        std::cerr << "Could not read " << options.input << "\n";
+        return 1;
+    }
+    std::vector<std::string> fens = read_positions(input_file);
+
+    std::ofstream output_file;
+    if (!options.output.empty()) {
+        output_file.open(options.output);
+        if (!output_file) {
+            std::cerr << "Could not write " << options.output << "\n";
+            return 1;
+        }
+    }
+    std::ostream& output = options.output.empty() ? std::cout : output_file;
+
+    // Every job searches with a table of its own unless they share one, and the engine-wide table
+    // is left unused
+    search::set_hash_size(1);
+    std::unique_ptr<TranspositionTable> shared_tt;
+    if (options.shared_hash) {
+        shared_tt = std::make_unique<TranspositionTable>(options.hash_size);
+    }
+
+    ResultWriter writer{&output, fens.size(), options.completion_order};
+    std::atomic<std::size_t> next_position{0};
+    std::atomic<std::uint64_t> total_nodes{0};
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<std::thread> jobs;
+    for (int id = 0; id < options.jobs; ++id) {
+        jobs.emplace_back([&]() {
+            std::unique_ptr<TranspositionTable> own_tt;
+            if (!shared_tt) {
+                own_tt = std::make_unique<TranspositionTable>(options.hash_size);
+            }
+            TranspositionTable* tt = shared_tt ? shared_tt.get() : own_tt.get();
+            search::SearchGlobals search_globals = search::SearchGlobals::new_search_globals();
+            search_globals.set_tt(tt);
+            search_globals.set_verbose(false);
+            search_globals.set_go_parameters(UAIGoParameters{
+                options.nodes, {}, options.depth, {}, {}, {}, {}, {}, false, false, {}});
+
+            std::size_t index;
+            while ((index = next_position++) < fens.size()) {
+                if (options.clear_hash && own_tt) {
+                    own_tt->clear();
+                }
+                auto position_start = std::chrono::steady_clock::now();
+                auto best_move = search::best_move_search(Position{fens[index]}, &search_globals);
+                auto time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now() - position_start)
+                                   .count();
+                total_nodes += search_globals.nodes();
+                writer.write(index,
+                             result_line(fens[index], best_move, search_globals, time_ms));
+            }
+        });
+    }
+    for (auto& job : jobs) {
+        job.join();
+    }
+
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::cerr << "Positions       : " << fens.size() << "\n"
+              << "Jobs            : " << options.jobs << "\n"
+              << "Nodes searched  : " << total_nodes << "\n"
+              << "Total time (ms) : " << std::uint64_t(seconds * 1000) << "\n"
+              << "Positions/second: " << fens.size() / std::max(seconds, 1e-9) << "\n"
+              << "Nodes/second    : " << std::uint64_t(total_nodes / std::max(seconds, 1e-9))
+              << std::endl;
+    return 0;
+}
+
+}  // namespace loltaxx::analyse
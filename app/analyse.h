@@ -0,0 +1,31 @@
+#ifndef LOLTAXX_ANALYSE_H
+#define LOLTAXX_ANALYSE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace loltaxx::analyse {
+
+static const int DEFAULT_JOBS = 1;
+static const int DEFAULT_HASH = 16;
+
+struct AnalyseOptions {
+    std::string input;
+    std::string output;
+    std::optional<int> depth;
+    std::optional<std::uint64_t> nodes;
+    int jobs;
+    int hash_size;
+    bool shared_hash;
+    bool clear_hash;
+    bool completion_order;
+};
+
+// Searches every position of an EPD or FEN file with a number of single-threaded searches side by
+// side in this process and writes one JSON line per position, then reports the throughput
+extern int analyse(const AnalyseOptions& options);
+
+}  // namespace loltaxx::analyse
+
+#endif  // LOLTAXX_ANALYSE_H
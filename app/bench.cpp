@@ -0,0 +1,223 @@
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "bench.h"
+#include "search.h"
+
+namespace loltaxx::bench {
+
+// Openings, mid-games and endgames across common gap layouts
+const std::vector<std::string> BENCH_FENS = {
+    "x5o/7/7/7/7/5x1/oo4x x 0 1",
+    "x4oo/5o1/6x/7/3x3/2x4/7 x 0 1",
+    "x4oo/1x5/1x5/3o1oo/4o2/3o3/4o2 x 2 1",
+    "oo3xx/1o3xx/oo4x/oo3x1/o5x/7/7 x 3 1",
+    "o1oooo1/1o1oxxx/2xxxx1/1ooox2/3o3/7/6x x 1 1",
+    "1oox3/xxoxx2/xx1xo2/xxoxoo1/ooxxoo1/1xx4/x4x1 o 2 1",
+    "o1xx1oo/xxxxooo/xxxxxoo/xoooxo1/1oxxx2/1oxxxo1/1oxx3 o 0 1",
+    "x5o/5o1/2-1-2/7/2-1-2/7/o4xx x 0 1",
+    "xx4o/7/2-1-o1/4oo1/2-1-2/7/o5x x 2 1",
+    "xx4o/xx5/2-1-2/7/2-1-2/4oxx/ooo2xx x 1 1",
+    "x1xx3/1xxx3/2-1-2/3x3/1o-1-2/3oo1o/2o4 x 1 1",
+    "ooooooo/oooooox/xx-1-oo/6o/2-1-2/4x2/o4xx x 0 1",
+    "xoooooo/xoo1ooo/xo-o-oo/ooooox1/2-1-2/7/o3x1x o 1 1",
+    "oooxxxo/oooxxxx/ox-x-1x/oxxxxoo/ox-x-o1/o2oo2/4x1x o 0 1",
+    "x4oo/7/3-3/2-1-2/3-x2/7/o6 x 0 1",
+    "xx4o/1x5/1o1-3/o1-1-2/3-3/o6/o5x x 1 1",
+    "ox4o/xxxoo2/1xx-3/2-1-2/3-3/7/o5x x 1 1",
+    "6o/7/1x1-2o/x1-1-o1/xo1-2o/xoo2oo/x6 x 3 1",
+    "1oo3o/ooo4/ooo-3/oo-1-2/oox-2o/1ooo3/2oo3 x 2 1",
+    "1oo4/x1oo3/oox-1x1/oo-1-1x/oo1-2x/oo3x1/1o2x2 o 2 1",
+    "1ooooox/oxoooox/1xx-xoo/ox-1-xo/oo1-oo1/o3ooo/o2x1o1 x 0 1",
+    "x2-2o/1x1-3/7/7/o6/3-3/3-2x x 1 1",
+    "x2-3/x2-o2/7/7/7/o2-3/oo1-xxx x 0 1",
+    "xxx-2o/2x-3/2xx3/2o4/1o5/3-3/o2-xxx x 1 1",
+    "x2-2o/3-2o/5oo/1oo2oo/1ooo2o/xxx-1o1/3-o2 x 0 1",
+    "xx1-1o1/1xx-3/x1xx3/ooo4/1o3oo/3-xoo/3-xxx x 4 1",
+    "1o1-3/1xo-3/oxooo1o/oxoooo1/o1ooxoo/1xx-2o/2x-3 o 3 1",
+    "3-xxx/ooo-oox/oooooox/1x1ooox/xxxooxx/xxx-1oo/3-2o o 1 1",
+    "5oo/1-3-1/2x4/7/7/1-3-1/o5x x 0 1",
+    "x2o2o/1-2o-1/7/7/7/1-3-1/oo3xx x 2 1",
+    "x3xo1/x-1o1-1/xx2o2/x6/x1x4/1-3-1/6x x 2 1",
+    "7/1-x2-1/1xx2o1/4o2/1xx1xx1/x-xx1-1/6x x 1 1",
+    "2ooxox/1-oox-1/1oo4/xooo3/1xoo3/1-o2-1/7 x 0 1",
+    "6o/1-o2-1/1xoxx2/1oooxx1/1oooxx1/o-ooo-1/xx5 o 0 1",
+    "oooxx1o/x-xxx-1/1xxooo1/1xoooox/1xooox1/1-ooo-1/1ooooo1 o 0 1",
+    "x-1-1-1/x3o2/-1-1-1-/7/-1-1-1-/7/o-1-1-x x 1 1",
+    "x-1-1-o/x3ooo/-x-1-1-/7/-1-1-1-/5x1/o-1-1-x x 0 1",
+    "1-o-1-o/1oo4/-o-1-1-/xxx4/-x-1-1-/7/o-1-1-x x 0 1",
+    "x-1-x-x/x2x1oo/-1-o-x-/3oox1/-1-1-1-/xxx3x/1-1-1-x x 1 1",
+    "1-1-1-1/4x2/-x-x-o-/1xxxooo/-o-o-o-/2xooo1/1-x-o-o x 2 1",
+    "1-1-1-x/x2ooox/-x-o-o-/2xxx1o/-1-1-x-/3xox1/o-x-o-o o 4 1",
+    "1-1-o-x/2xxoxx/-x-x-x-/xxxxx1o/-x-x-x-/1oooo2/1-o-1-1 o 0 1",
+    "x5o/1x5/7/3-3/7/1o5/o5x x 0 1",
+    "x4o1/xx5/7/3-3/5o1/6o/o5x x 1 1",
+    "xx5/x1o3o/3o2o/3-3/5oo/5oo/o6 x 1 1",
+    "1oo4/1ooo3/1xx4/2x-3/7/7/o6 x 5 1",
+    "2x1x2/3x3/2o4/1oo-1x1/1oo2xx/1o2x2/o5x x 5 1",
+    "6x/1xxx3/oxxxxx1/oox-o2/1oxx3/xxxx3/1xoo2o o 0 1",
+    "x4xx/xxooox1/xxoxxx1/oxx-xx1/xxxxxxx/ooxooo1/xxxoo2 o 0 1",
+};
+
+struct RunResult {
+    double time_ms;
+    std::uint64_t nodes;
+};
+
+// Mean and half-width of the 95% confidence interval under a normal approximation
+std::pair<double, double> mean_interval(const std::vector<double>& samples) {
+    double mean = 0.0;
+    for (double sample : samples) {
+        mean += sample;
+    }
+    mean /= samples.size();
+    if (samples.size() < 2) {
+        return {mean, 0.0};
+    }
+
+    double variance = 0.0;
+    for (double sample : samples) {
+        variance += (sample - mean) * (sample - mean);
+    }
+    variance /= samples.size() - 1;
+    return {mean, 1.96 * std::sqrt(variance / samples.size())};
+}
+
+RunResult bench_run(search::SearchGlobals* search_globals) {
+    RunResult result{0.0, 0};
+    for (const auto& fen : BENCH_FENS) {
+        search::clear_hash();
+        auto start_time = std::chrono::steady_clock::now();
+        search::best_move_search(Position{fen}, search_globals);
+        result.time_ms += std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start_time)
+                              .count();
+        result.nodes += search_globals->nodes();
+    }
+    return result;
+}
+
+int bench(int depth, int num_threads, int hash_size) {
+    search::set_hash_size(hash_size);
+    search::SearchGlobals search_globals = search::SearchGlobals::new_search_globals();
+    search_globals.set_num_threads(num_threads);
+    search_globals.set_verbose(false);
+    search_globals.set_go_parameters(
+        UAIGoParameters{{}, {}, depth, {}, {}, {}, {}, {}, false, false, {}});
+
+    std::vector<std::uint64_t> position_nodes;
+    std::uint64_t total_nodes = 0;
+    std::uint64_t eval_cache_hits = 0;
+    std::uint64_t eval_cache_probes = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < BENCH_FENS.size(); ++i) {
+        search::clear_hash();
+        auto best_move = search::best_move_search(Position{BENCH_FENS[i]}, &search_globals);
+        std::uint64_t nodes = search_globals.nodes();
+        position_nodes.push_back(nodes);
+        total_nodes += nodes;
+        eval_cache_hits += search_globals.eval_cache_hits();
+        eval_cache_probes += search_globals.eval_cache_probes();
+        std::cout << "Position " << (i + 1) << "/" << BENCH_FENS.size() << ": "
+                  << (best_move ? best_move->to_str() : "0000") << " " << nodes << " nodes\n";
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time);
+
+    std::uint64_t time_taken = elapsed.count();
+    std::uint64_t nps = time_taken ? total_nodes * 1000 / time_taken : total_nodes;
+    std::cout << "\nTotal time (ms) : " << time_taken << "\n";
+    std::cout << "Nodes searched  : " << total_nodes << "\n";
+    std::cout << "Nodes/second    : " << nps << "\n";
+    double eval_cache_hit_rate = eval_cache_probes ? double(eval_cache_hits) / eval_cache_probes
+                                                   : 0.0;
+    std::cout << "Eval cache hits : " << eval_cache_hits << "/" << eval_cache_probes << " ("
+              << std::fixed << std::setprecision(1) << 100.0 * eval_cache_hit_rate << "%)\n";
+
+    std::cout << "{\"depth\": " << depth << ", \"threads\": " << num_threads
+              << ", \"hash\": " << hash_size << ", \"positions\": " << BENCH_FENS.size()
+              << ", \"nodes\": " << total_nodes << ", \"time_ms\": " << time_taken
+              << ", \"nps\": " << nps << ", \"eval_cache_hits\": " << eval_cache_hits
+              << ", \"eval_cache_probes\": " << eval_cache_probes
+              << ", \"position_nodes\": [";
+    for (std::size_t i = 0; i < position_nodes.size(); ++i) {
+        std::cout << (i ? ", " : "") << position_nodes[i];
+    }
+    std::cout << "]}" << std::endl;
+
+    return 0;
+}
+
+int smp_bench(int max_threads, int depth, int runs, int hash_size) {
+    search::set_hash_size(hash_size);
+    search::SearchGlobals search_globals = search::SearchGlobals::new_search_globals();
+    search_globals.set_verbose(false);
+    search_globals.set_go_parameters(
+        UAIGoParameters{{}, {}, depth, {}, {}, {}, {}, {}, false, false, {}});
+
+    std::vector<std::vector<RunResult>> results(max_threads);
+    for (int num_threads = 1; num_threads <= max_threads; ++num_threads) {
+        search_globals.set_num_threads(num_threads);
+        for (int run = 0; run < runs; ++run) {
+            results[num_threads - 1].push_back(bench_run(&search_globals));
+        }
+    }
+
+    auto single_threaded = results[0];
+    double base_time = 0.0;
+    double base_nodes = 0.0;
+    for (const auto& run : single_threaded) {
+        base_time += run.time_ms;
+        base_nodes += run.nodes;
+    }
+    base_time /= runs;
+    base_nodes /= runs;
+    double base_nps = base_nodes * 1000.0 / base_time;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "threads  time-to-depth (ms)        nps  nps-scaling  node-ratio  speedup\n";
+    std::string json = "[";
+    for (int num_threads = 1; num_threads <= max_threads; ++num_threads) {
+        std::vector<double> times;
+        std::vector<double> speedups;
+        std::vector<double> nps_values;
+        std::vector<double> node_ratios;
+        for (const auto& run : results[num_threads - 1]) {
+            times.push_back(run.time_ms);
+            speedups.push_back(base_time / run.time_ms);
+            nps_values.push_back(run.nodes * 1000.0 / run.time_ms);
+            node_ratios.push_back(run.nodes / base_nodes);
+        }
+        auto [time, time_error] = mean_interval(times);
+        auto [speedup, speedup_error] = mean_interval(speedups);
+        auto [nps, nps_error] = mean_interval(nps_values);
+        auto [node_ratio, node_ratio_error] = mean_interval(node_ratios);
+
+        std::cout << std::setw(7) << num_threads << std::setw(11) << time << " +- "
+                  << std::setw(8) << time_error << std::setw(11) << std::uint64_t(nps)
+                  << std::setw(13) << nps / base_nps << std::setw(12) << node_ratio
+                  << std::setw(9) << speedup << " +- " << speedup_error << "\n";
+
+        std::ostringstream entry;
+        entry << std::fixed << std::setprecision(4) << (num_threads > 1 ? ", " : "")
+              << "{\"threads\": " << num_threads << ", \"time_ms\": " << time
+              << ", \"time_ms_ci\": " << time_error << ", \"nps\": " << nps
+              << ", \"nps_ci\": " << nps_error << ", \"nps_scaling\": " << nps / base_nps
+              << ", \"node_ratio\": " << node_ratio
+              << ", \"node_ratio_ci\": " << node_ratio_error << ", \"speedup\": " << speedup
+              << ", \"speedup_ci\": " << speedup_error << "}";
+        json += entry.str();
+    }
+    json += "]";
+
+    std::cout << "{\"depth\": " << depth << ", \"runs\": " << runs << ", \"hash\": " << hash_size
+              << ", \"positions\": " << BENCH_FENS.size() << ", \"results\": " << json << "}"
+              << std::endl;
+
+    return 0;
+}
+
+}  // namespace loltaxx::bench
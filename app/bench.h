@@ -0,0 +1,26 @@
+#ifndef LOLTAXX_BENCH_H
+#define LOLTAXX_BENCH_H
+
+#include <string>
+#include <vector>
+
+namespace loltaxx::bench {
+
+static const int DEFAULT_DEPTH = 5;
+static const int DEFAULT_THREADS = 1;
+static const int DEFAULT_HASH = 16;
+static const int DEFAULT_SMP_RUNS = 5;
+
+extern const std::vector<std::string> BENCH_FENS;
+
+// Searches every bench position to a fixed depth and reports the total node count, which
+// changes whenever search behaviour does, along with the aggregate speed
+extern int bench(int depth, int num_threads, int hash_size);
+
+// Repeats the bench at every thread count up to max_threads and reports time-to-depth, NPS
+// scaling, node counts relative to one thread and the effective speedup with 95% intervals
+extern int smp_bench(int max_threads, int depth, int runs, int hash_size);
+
+}  // namespace loltaxx::bench
+
+#endif  // LOLTAXX_BENCH_H
@@ -34,6 +34,9 @@ class Bitboard {
     constexpr operator value_type() const {
         return value_;
     }
+    [[nodiscard]] constexpr static Bitboard full() {
+        return Bitboard{BB_FULL};
+    }
 
     [[nodiscard]] constexpr Bitboard operator<<(int shift) const {
         return Bitboard{(value_ << unsigned(shift))};
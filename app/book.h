@@ -0,0 +1,140 @@
+#ifndef LOLTAXX_BOOK_H
+#define LOLTAXX_BOOK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "position.h"
+
+namespace loltaxx {
+
+// An opening book is a list of (hash, move, weight, score) records sorted by hash, with the
+// records of one position ordered by decreasing weight. The weight is how often the move was
+// chosen while building, the score is the search score for the side to move when known.
+class Book {
+   public:
+    struct Record {
+        std::uint64_t hash;
+        std::uint16_t move;
+        std::uint16_t weight;
+        std::int32_t score;
+    };
+    static_assert(sizeof(Record) == 16);
+
+   private:
+    constexpr static char MAGIC[8]{'L', 'T', 'X', 'B', 'O', 'O', 'K', '\0'};
+    constexpr static std::uint32_t VERSION = 1;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t record_size;
+        std::uint64_t num_records;
+    };
+
+   public:
+    Book() = default;
+    Book(const Book&) = delete;
+    Book& operator=(const Book&) = delete;
+
+    ~Book() {
+        unload();
+    }
+
+    bool load(const std::string& path) {
+        unload();
+        if (!file_.open(path) || file_.size() < sizeof(Header)) {
+            file_.close();
+            return false;
+        }
+
+        Header header{};
+        std::memcpy(&header, file_.data(), sizeof(Header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+            header.record_size != sizeof(Record) ||
+            file_.size() < sizeof(Header) + header.num_records * sizeof(Record)) {
+            file_.close();
+            return false;
+        }
+
+        records_ = reinterpret_cast<const Record*>(file_.data() + sizeof(Header));
+        num_records_ = header.num_records;
+        return true;
+    }
+    void unload() {
+        file_.close();
+        records_ = nullptr;
+        num_records_ = 0;
+    }
+
+    [[nodiscard]] bool loaded() const noexcept {
+        return records_ != nullptr;
+    }
+    [[nodiscard]] std::size_t size() const noexcept {
+        return num_records_;
+    }
+
+    // Binary search for the first record of the position, a few cache lines of the mapping
+    [[nodiscard]] std::pair<const Record*, const Record*> records(std::uint64_t hash) const {
+        if (!records_) {
+            return {nullptr, nullptr};
+        }
+        return std::equal_range(records_, records_ + num_records_, Record{hash, 0, 0, 0},
+                                [](const Record& lhs, const Record& rhs) {
+                                    return lhs.hash < rhs.hash;
+                                });
+    }
+
+    // The heaviest move which is legal in the position, which also guards against hash
+    // collisions with positions outside the book
+    [[nodiscard]] std::optional<Move> probe(const Position& pos) const {
+        auto [first, last] = records(pos.hash());
+        if (first == last) {
+            return {};
+        }
+        MoveList legal_moves = pos.legal_moves();
+        for (const Record* record = first; record != last; ++record) {
+            Move move{std::uint32_t(record->move)};
+            if (legal_moves.contains(move)) {
+                return move;
+            }
+        }
+        return {};
+    }
+
+    static bool write(const std::string& path, std::vector<Record> records) {
+        std::sort(records.begin(), records.end(), [](const Record& lhs, const Record& rhs) {
+            if (lhs.hash != rhs.hash) {
+                return lhs.hash < rhs.hash;
+            }
+            return lhs.weight > rhs.weight;
+        });
+
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.record_size = sizeof(Record);
+        header.num_records = records.size();
+
+        std::ofstream file{path, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char*>(records.data()),
+                   std::streamsize(records.size() * sizeof(Record)));
+        return bool(file);
+    }
+
+   private:
+    MappedFile file_;
+    const Record* records_ = nullptr;
+    std::uint64_t num_records_ = 0;
+};
+
+}  // namespace loltaxx
+
+#endif  // LOLTAXX_BOOK_H
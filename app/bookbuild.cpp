@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include "CLI11/CLI11.hpp"
+
+#include "book.h"
+#include "search.h"
+
+using namespace loltaxx;
+
+namespace {
+
+using RecordKey = std::pair<std::uint64_t, std::uint16_t>;
+
+void add_record(std::map<RecordKey, Book::Record>* records,
+                std::uint64_t hash,
+                Move move,
+                int score) {
+    auto key = RecordKey{hash, std::uint16_t(move.value())};
+    auto [it, inserted] = records->try_emplace(key, Book::Record{hash, key.second, 0, score});
+    it->second.weight = std::uint16_t(std::min(it->second.weight + 1, 0xffff));
+}
+
+// Every position within the given plies of the start position is searched and its best move
+// recorded. Transpositions are searched once.
+void build_from_search(Position pos,
+                       int ply,
+                       int plies,
+                       search::SearchGlobals* search_globals,
+                       std::unordered_set<std::uint64_t>* visited,
+                       std::map<RecordKey, Book::Record>* records) {
+    if (!visited->insert(pos.hash()).second) {
+        return;
+    }
+    MoveList legal_moves = pos.legal_moves();
+    if (legal_moves.empty() || legal_moves[0] == constants::MOVE_NULL) {
+        return;
+    }
+
+    search::clear_hash();
+    auto best_move = search::best_move_search(pos, search_globals);
+    if (best_move) {
+        add_record(records, pos.hash(), *best_move, search_globals->score());
+    }
+
+    if (ply >= plies) {
+        return;
+    }
+    for (Move move : legal_moves) {
+        Position child = pos;
+        child.make_move(move);
+        build_from_search(child, ply + 1, plies, search_globals, visited, records);
+    }
+}
+
+// Game records hold one game per line in the form of a UAI position command without the leading
+// "position", either "startpos moves ..." or "fen <fen> moves ...". Each move made within the
+// given plies counts once towards its weight.
+bool build_from_games(const std::string& path,
+                      int plies,
+                      std::map<RecordKey, Book::Record>* records) {
+    std::ifstream file{path};
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream tokens{line};
+        std::string token;
+        if (!(tokens >> token)) {
+            continue;
+        }
+
+        std::string fen = constants::STARTPOS_FEN;
+        if (token == "fen") {
+            fen.clear();
+            while (tokens >> token && token != "moves") {
+                fen += (fen.empty() ? "" : " ") + token;
+            }
+        } else if (token != "startpos" || !(tokens >> token) || token != "moves") {
+            continue;
+        }
+
+        Position pos{fen};
+        for (int ply = 0; ply < plies && tokens >> token; ++ply) {
+            auto move = Move::from(token);
+            if (!move || !pos.legal_moves().contains(*move)) {
+                break;
+            }
+            add_record(records, pos.hash(), *move, 0);
+            pos.make_move(*move);
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string output;
+    std::vector<std::string> games;
+    int plies = 2;
+    int depth = 8;
+    int hash_size = 128;
+    int num_threads = int(std::max(1U, std::thread::hardware_concurrency()));
+
+    CLI::App app{"Builds an opening book from searches of the early positions or game records."};
+    app.add_option("-o,--output", output, "Book file to write.")->required();
+    app.add_option("-g,--games", games, "Game record files, one game per line.");
+    app.add_option("-p,--plies", plies, "Plies from the start of the game covered.", true);
+    app.add_option("-d,--depth", depth, "Search depth for each position.", true);
+    app.add_option("-t,--threads", num_threads, "Threads to search with.", true);
+    app.add_option("--hash", hash_size, "Hash size in MB.", true);
+    CLI11_PARSE(app, argc, argv);
+
+    std::map<RecordKey, Book::Record> records;
+    auto start = std::chrono::steady_clock::now();
+    if (games.empty()) {
+        search::set_hash_size(std::clamp(hash_size, 1, 65536));
+        search::SearchGlobals search_globals = search::SearchGlobals::new_search_globals();
+        search_globals.set_num_threads(std::clamp(num_threads, 1, 256));
+        search_globals.set_verbose(false);
+        search_globals.set_go_parameters(UAIGoParameters{
+            {}, {}, std::clamp(depth, 1, search::MAX_PLY), {}, {}, {}, {}, {}, false, false, {}});
+
+        std::unordered_set<std::uint64_t> visited;
+        build_from_search(Position{constants::STARTPOS_FEN}, 0, std::max(plies, 0),
+                          &search_globals, &visited, &records);
+    } else {
+        for (const auto& path : games) {
+            if (!build_from_games(path, std::max(plies, 0), &records)) {
+                std::cerr << "Could not read " << path << "\n";
+                return 1;
+            }
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    std::vector<Book::Record> book_records;
+    for (const auto& [key, record] : records) {
+        book_records.push_back(record);
+    }
+    std::cout << "Records   : " << book_records.size() << "\n"
+              << "Time (ms) : " << elapsed.count() << "\n";
+
+    if (!Book::write(output, book_records)) {
+        std::cerr << "Could not write " << output << "\n";
+        return 1;
+    }
+    return 0;
+}
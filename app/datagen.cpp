@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "CLI11/CLI11.hpp"
+
+#include "packed_position.h"
+#include "search.h"
+#include "tt.h"
+
+using namespace loltaxx;
+
+namespace {
+
+struct DatagenOptions {
+    std::string output;
+    std::uint64_t nodes;
+    std::uint64_t max_positions;
+    std::uint64_t shard_size;
+    double rate;
+    int random_plies;
+    int hash_size;
+    std::uint64_t seed;
+};
+
+struct Progress {
+    std::atomic<std::uint64_t> games{0};
+    std::atomic<std::uint64_t> positions{0};
+    std::atomic<std::uint64_t> skipped{0};
+    std::atomic<bool> done{false};
+};
+
+// Positions are written as each game ends, into shards of a fixed number of positions per
+// thread, so a run can be stopped at any time and leave only whole games behind
+class ShardWriter {
+   public:
+    ShardWriter(std::string output, int thread_id, std::uint64_t shard_size)
+        : output_(std::move(output)), thread_id_(thread_id), shard_size_(shard_size) {
+    }
+
+    bool write(const std::vector<PackedPosition>& positions) {
+        if (num_shards_ == 0 || shard_positions_ >= shard_size_) {
+            if (!writer_.open(output_ + "_" + std::to_string(thread_id_) + "_" +
+                              std::to_string(num_shards_++) + ".bin")) {
+                return false;
+            }
+            shard_positions_ = 0;
+        }
+        shard_positions_ += positions.size();
+        return writer_.write(positions.data(), positions.size()) && writer_.flush();
+    }
+
+   private:
+    std::string output_;
+    int thread_id_;
+    std::uint64_t shard_size_;
+    PackedWriter writer_;
+    std::uint64_t shard_positions_ = 0;
+    int num_shards_ = 0;
+};
+
+// The game is over once a side has no pieces, the board is full, neither side can move or the
+// fifty-move rule applies, and is then decided on the piece count
+std::optional<PackedPosition::Result> game_result(const Position& pos) {
+    int crosses = pos.pieces(constants::CROSS).popcount();
+    int knots = pos.pieces(constants::KNOT).popcount();
+    if (pos.halfmoves() >= 100) {
+        return PackedPosition::DRAW;
+    }
+
+    bool over = !crosses || !knots || !pos.empty_squares();
+    if (!over && pos.legal_moves()[0] == constants::MOVE_NULL) {
+        Position passed = pos;
+        passed.make_move(constants::MOVE_NULL);
+        over = passed.legal_moves()[0] == constants::MOVE_NULL;
+    }
+    if (!over) {
+        return {};
+    }
+    if (crosses == knots) {
+        return PackedPosition::DRAW;
+    }
+    return crosses > knots ? PackedPosition::CROSS_WIN : PackedPosition::CROSS_LOSS;
+}
+
+// Random moves from a random opening position, replayed until the game is still going after them
+Position random_opening(const std::vector<Position>& openings,
+                        int random_plies,
+                        std::mt19937_64* rng) {
+    while (true) {
+        Position pos = openings[(*rng)() % openings.size()];
+        for (int ply = 0; ply < random_plies && !game_result(pos); ++ply) {
+            MoveList legal_moves = pos.legal_moves();
+            pos.make_move(legal_moves[int((*rng)() % legal_moves.size())]);
+        }
+        if (!game_result(pos)) {
+            return pos;
+        }
+    }
+}
+
+// Plays games at a fixed node count per move with a table of its own, and throttles itself when
+// all threads together are ahead of the target rate
+void play_games(int thread_id,
+                const DatagenOptions& options,
+                const std::vector<Position>& openings,
+                Progress* progress) {
+    std::mt19937_64 rng{options.seed + std::uint64_t(thread_id)};
+    TranspositionTable tt{options.hash_size};
+    search::SearchGlobals search_globals = search::SearchGlobals::new_search_globals();
+    search_globals.set_tt(&tt);
+    search_globals.set_verbose(false);
+    search_globals.set_go_parameters(
+        UAIGoParameters{options.nodes, {}, {}, {}, {}, {}, {}, {}, false, false, {}});
+    ShardWriter writer{options.output, thread_id, options.shard_size};
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PackedPosition> game;
+    std::vector<Position> positions;
+    std::vector<int> scores;
+    while (!progress->done) {
+        tt.clear();
+        positions.clear();
+        scores.clear();
+
+        Position pos = random_opening(openings, options.random_plies, &rng);
+        std::optional<PackedPosition::Result> result;
+        while (!(result = game_result(pos))) {
+            if (pos.legal_moves()[0] == constants::MOVE_NULL) {
+                pos.make_move(constants::MOVE_NULL);
+                continue;
+            }
+            auto best_move = search::best_move_search(pos, &search_globals);
+            // A search can stop before it has a move to play, and a game without its ending has
+            // no result to label its positions with
+            if (!best_move) {
+                break;
+            }
+            positions.push_back(pos);
+            scores.push_back(search_globals.score());
+            pos.make_move(*best_move);
+        }
+        if (!result) {
+            progress->skipped += 1;
+            continue;
+        }
+
+        game.clear();
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            game.push_back(PackedPosition::pack(positions[i], scores[i], *result));
+        }
+        if (!writer.write(game)) {
+            std::cerr << "Could not write " << options.output << " shards\n";
+            progress->done = true;
+            break;
+        }
+        progress->games += 1;
+        std::uint64_t total = progress->positions += game.size();
+        if (options.max_positions && total >= options.max_positions) {
+            progress->done = true;
+        }
+
+        if (options.rate > 0.0) {
+            auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                   std::chrono::duration<double>(total / options.rate));
+            while (!progress->done && std::chrono::steady_clock::now() < due) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    DatagenOptions options{"data", 5000, 0, 1000000, 0.0, 8, 16, 0};
+    std::string opening_file;
+    std::string eval_file;
+    std::string pattern_file;
+    int num_threads = int(std::max(1U, std::thread::hardware_concurrency()));
+
+    CLI::App app{"Generates scored positions from self-play games for training."};
+    app.add_option("-o,--output", options.output, "Prefix of the shard files.", true);
+    app.add_option("-n,--nodes", options.nodes, "Nodes searched per move.", true);
+    app.add_option("-p,--positions", options.max_positions, "Positions to stop after, 0 for none.",
+                   true);
+    app.add_option("-s,--shard-size", options.shard_size, "Positions per shard file.", true);
+    app.add_option("-r,--rate", options.rate, "Target positions per second, 0 for no limit.",
+                   true);
+    app.add_option("--random-plies", options.random_plies, "Random moves opening each game.", true);
+    app.add_option("--openings", opening_file, "FENs to open from, one per line.");
+    app.add_option("--hash", options.hash_size, "Hash size in MB for each thread.", true);
+    app.add_option("--seed", options.seed, "Seed of the random openings.", true);
+    app.add_option("--eval-file", eval_file, "Network to play with.");
+    app.add_option("--pattern-file", pattern_file, "Pattern weights to play with.");
+    app.add_option("-t,--threads", num_threads, "Games played at once.", true);
+    CLI11_PARSE(app, argc, argv);
+    num_threads = std::clamp(num_threads, 1, 256);
+    options.hash_size = std::clamp(options.hash_size, 1, 65536);
+    options.shard_size = std::max<std::uint64_t>(options.shard_size, 1);
+
+    if (!eval_file.empty() && !nnue::load(eval_file)) {
+        std::cerr << "Could not load " << eval_file << "\n";
+        return 1;
+    }
+    if (!pattern_file.empty() && !patterns::load(pattern_file)) {
+        std::cerr << "Could not load " << pattern_file << "\n";
+        return 1;
+    }
+
+    std::vector<Position> openings;
+    if (opening_file.empty()) {
+        openings.emplace_back(constants::STARTPOS_FEN);
+    } else {
+        std::ifstream file{opening_file};
+        if (!file) {
+            std::cerr << "Could not read " << opening_file << "\n";
+            return 1;
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty()) {
+                openings.emplace_back(line);
+            }
+        }
+    }
+    openings.erase(std::remove_if(openings.begin(), openings.end(),
+                                  [](const Position& pos) { return bool(game_result(pos)); }),
+                   openings.end());
+    if (openings.empty()) {
+        std::cerr << "No playable openings\n";
+        return 1;
+    }
+    // The engine-wide table is not used, each thread has its own
+    search::set_hash_size(1);
+
+    Progress progress;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int id = 0; id < num_threads; ++id) {
+        threads.emplace_back(play_games, id, std::cref(options), std::cref(openings), &progress);
+    }
+
+    auto report = [&]() {
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::uint64_t positions = progress.positions;
+        std::cout << "Games " << progress.games << " skipped " << progress.skipped << " positions "
+                  << positions << " positions/s "
+                  << std::uint64_t(positions / std::max(seconds, 1e-9)) << " time "
+                  << std::uint64_t(seconds) << "s" << std::endl;
+    };
+    while (true) {
+        for (int tick = 0; tick < 100 && !progress.done; ++tick) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (progress.done) {
+            break;
+        }
+        report();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    report();
+    return 0;
+}
@@ -0,0 +1,814 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CLI11/CLI11.hpp"
+
+#include "game_record.h"
+#include "mapped_file.h"
+#include "packed_position.h"
+
+using namespace loltaxx;
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Position reads the board without checks, so a board field which does not hold seven ranks of
+// seven squares, each a piece, a gap or part of a count of empty squares, is refused before that
+bool valid_board(std::string_view board) {
+    int ranks = 1;
+    int squares = 0;
+    for (char c : board) {
+        if (c == '/') {
+            if (squares != 7) {
+                return false;
+            }
+            ++ranks;
+            squares = 0;
+        } else if (c >= '1' && c <= '7') {
+            squares += c - '0';
+        } else if (c == '-' || Piece::from(c)) {
+            ++squares;
+        } else {
+            return false;
+        }
+        if (squares > 7) {
+            return false;
+        }
+    }
+    return ranks == 7 && squares == 7;
+}
+
+// One labelled position per line, "<fen> | <score> | <result>", with the score for the side to
+// move and the result for crosses as 1.0, 0.5 or 0.0. The labels may be left out, and then read
+// as a score of 0 and a draw.
+bool parse_line(std::string_view line, PackedPosition* packed) {
+    auto first_bar = line.find('|');
+    std::string fen{line.substr(0, first_bar)};
+    auto board_begin = fen.find_first_not_of(" \t\r");
+    if (board_begin == std::string::npos || fen[board_begin] == '#') {
+        return false;
+    }
+    auto board_end = fen.find_first_of(" \t\r", board_begin);
+    if (!valid_board(std::string_view{fen}.substr(board_begin, board_end - board_begin))) {
+        return false;
+    }
+
+    int score = 0;
+    double result = 0.5;
+    if (first_bar != std::string_view::npos) {
+        std::string labels{line.substr(first_bar + 1)};
+        const char* begin = labels.c_str();
+        char* end;
+        score = int(std::strtol(begin, &end, 10));
+        if (end == begin) {
+            return false;
+        }
+        begin = std::strchr(end, '|');
+        if (begin) {
+            result = std::strtod(begin + 1, &end);
+        }
+    }
+
+    Position pos{fen};
+    auto outcome = result > 0.75   ? PackedPosition::CROSS_WIN
+                   : result < 0.25 ? PackedPosition::CROSS_LOSS
+                                   : PackedPosition::DRAW;
+    *packed = PackedPosition::pack(pos, score, outcome);
+    return true;
+}
+
+// Each input is mapped and split into one block of whole lines per thread. The first thread
+// writes straight to the output and the others to part files of their own, which are appended
+// after it in order once all are done. The output keeps the input order, and no thread holds more
+// than its write buffer.
+int convert(const std::vector<std::string>& inputs, const std::string& output, int num_threads) {
+    auto start = std::chrono::steady_clock::now();
+    PackedWriter writer;
+    if (!writer.open(output)) {
+        std::cerr << "Could not write " << output << "\n";
+        return 1;
+    }
+
+    std::vector<std::string> parts;
+    for (int id = 1; id < num_threads; ++id) {
+        parts.push_back(output + "_" + std::to_string(id) + ".tmp");
+    }
+    auto remove_parts = [&parts]() {
+        for (const auto& part : parts) {
+            std::remove(part.c_str());
+        }
+    };
+
+    std::uint64_t converted = 0;
+    std::uint64_t skipped = 0;
+    for (const auto& path : inputs) {
+        MappedFile file;
+        if (!file.open(path, true)) {
+            std::cerr << "Could not read " << path << "\n";
+            remove_parts();
+            return 1;
+        }
+        std::string_view text{file.data(), file.size()};
+
+        std::vector<std::size_t> bounds{0};
+        for (int id = 1; id < num_threads; ++id) {
+            std::size_t bound = std::max(bounds.back(), text.size() * id / num_threads);
+            bound = std::min(text.find('\n', bound), text.size());
+            bounds.push_back(bound == text.size() ? bound : bound + 1);
+        }
+        bounds.push_back(text.size());
+
+        std::vector<std::uint64_t> block_converted(num_threads);
+        std::vector<std::uint64_t> block_skipped(num_threads);
+        std::atomic<bool> failed{false};
+        std::vector<std::thread> threads;
+        for (int id = 0; id < num_threads; ++id) {
+            threads.emplace_back([&, id]() {
+                std::optional<PackedWriter> part_writer;
+                PackedWriter* block_writer = &writer;
+                if (id > 0) {
+                    block_writer = &part_writer.emplace();
+                    if (!block_writer->open(parts[id - 1])) {
+                        failed = true;
+                        return;
+                    }
+                }
+
+                std::string_view block = text.substr(bounds[id], bounds[id + 1] - bounds[id]);
+                while (!block.empty() && !failed) {
+                    std::size_t end = std::min(block.find('\n'), block.size());
+                    PackedPosition packed{};
+                    if (parse_line(block.substr(0, end), &packed)) {
+                        if (!block_writer->write(packed)) {
+                            failed = true;
+                        }
+                        ++block_converted[id];
+                    } else if (block.substr(0, end).find_first_not_of(" \t\r") !=
+                               std::string_view::npos) {
+                        ++block_skipped[id];
+                    }
+                    block.remove_prefix(std::min(end + 1, block.size()));
+                }
+                if (!(part_writer ? part_writer->close() : writer.flush())) {
+                    failed = true;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (int id = 1; id < num_threads && !failed; ++id) {
+            PackedReader part;
+            if (!part.open(parts[id - 1]) || !writer.write(part.begin(), part.size())) {
+                failed = true;
+            }
+        }
+        if (failed) {
+            std::cerr << "Could not write " << output << "\n";
+            remove_parts();
+            return 1;
+        }
+        for (int id = 0; id < num_threads; ++id) {
+            converted += block_converted[id];
+            skipped += block_skipped[id];
+        }
+    }
+    remove_parts();
+    if (!writer.close()) {
+        std::cerr << "Could not write " << output << "\n";
+        return 1;
+    }
+
+    double seconds = seconds_since(start);
+    std::cout << "Positions   : " << converted << "\n"
+              << "Skipped     : " << skipped << "\n"
+              << "Time (ms)   : " << std::uint64_t(seconds * 1000) << "\n"
+              << "Positions/s : " << std::uint64_t(converted / std::max(seconds, 1e-9)) << "\n";
+    return 0;
+}
+
+// One game per line in the form of a UAI position command without the leading "position", as
+// bookbuild reads them, optionally followed by "| <result>" with the result for crosses as 1.0,
+// 0.5 or 0.0. The result may be left out, and then reads as a draw.
+bool parse_game(const std::string& line, GameRecord* game) {
+    auto bar = line.find('|');
+    std::istringstream tokens{line.substr(0, bar)};
+    std::string token;
+    if (!(tokens >> token)) {
+        return false;
+    }
+
+    std::string fen = constants::STARTPOS_FEN;
+    if (token == "fen") {
+        fen.clear();
+        while (tokens >> token && token != "moves") {
+            fen += (fen.empty() ? "" : " ") + token;
+        }
+    } else if (token != "startpos" || !(tokens >> token) || token != "moves") {
+        return false;
+    }
+
+    game->start = Position{fen};
+    game->moves.clear();
+    Position pos = game->start;
+    while (tokens >> token) {
+        auto move = Move::from(token);
+        if (!move || !pos.legal_moves().contains(*move)) {
+            return false;
+        }
+        game->moves.push_back(*move);
+        pos.make_move(*move);
+    }
+
+    double result = bar == std::string::npos ? 0.5 : std::strtod(line.c_str() + bar + 1, nullptr);
+    game->result = result > 0.75   ? PackedPosition::CROSS_WIN
+                   : result < 0.25 ? PackedPosition::CROSS_LOSS
+                                   : PackedPosition::DRAW;
+    return true;
+}
+
+int encode_games(const std::vector<std::string>& inputs, const std::string& output) {
+    auto start = std::chrono::steady_clock::now();
+    GameWriter writer;
+    if (!writer.open(output)) {
+        std::cerr << "Could not write " << output << "\n";
+        return 1;
+    }
+
+    std::uint64_t games = 0;
+    std::uint64_t skipped = 0;
+    std::uint64_t text_bytes = 0;
+    for (const auto& path : inputs) {
+        std::ifstream file{path};
+        if (!file) {
+            std::cerr << "Could not read " << path << "\n";
+            return 1;
+        }
+        std::string line;
+        GameRecord game;
+        while (std::getline(file, line)) {
+            text_bytes += line.size() + 1;
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+            if (!parse_game(line, &game) || !writer.write(game)) {
+                ++skipped;
+                continue;
+            }
+            ++games;
+        }
+    }
+    if (!writer.close()) {
+        std::cerr << "Could not write " << output << "\n";
+        return 1;
+    }
+
+    double seconds = seconds_since(start);
+    double moves = double(std::max<std::uint64_t>(writer.moves(), 1));
+    std::cout << "Games         : " << games << "\n"
+              << "Skipped       : " << skipped << "\n"
+              << "Moves         : " << writer.moves() << "\n"
+              << "Bytes         : " << writer.bytes() << " from " << text_bytes << "\n"
+              << "Bits per move : " << 8.0 * writer.bytes() / moves << "\n"
+              << "Time (ms)     : " << std::uint64_t(seconds * 1000) << "\n";
+    return 0;
+}
+
+// Replays the games into packed positions, one for the position before each move labelled with
+// the game result and a score of 0, or back into text when `text` is set
+int decode_games(const std::vector<std::string>& inputs, const std::string& output, bool text) {
+    auto start = std::chrono::steady_clock::now();
+    PackedWriter packed_writer;
+    std::ofstream text_writer;
+    if (!(text ? (text_writer.open(output), bool(text_writer)) : packed_writer.open(output))) {
+        std::cerr << "Could not write " << output << "\n";
+        return 1;
+    }
+
+    std::uint64_t games = 0;
+    std::uint64_t positions = 0;
+    GameRecord game;
+    for (const auto& path : inputs) {
+        GameReader reader;
+        if (!reader.open(path)) {
+            std::cerr << "Could not read " << path << "\n";
+            return 1;
+        }
+        while (reader.next(&game)) {
+            ++games;
+            positions += game.moves.size();
+            if (text) {
+                text_writer << "fen " << game.start.fen() << " moves";
+                for (Move move : game.moves) {
+                    text_writer << ' ' << move;
+                }
+                text_writer << " | " << game.result / 2.0 << '\n';
+            } else {
+                replay(game, [&](const Position& pos, Move) {
+                    packed_writer.write(PackedPosition::pack(pos, 0, game.result));
+                });
+            }
+        }
+        if (reader.failed()) {
+            std::cerr << "Damaged block in " << path << " after " << games << " games\n";
+            return 1;
+        }
+    }
+    if (!(text ? bool(text_writer.flush()) : packed_writer.close())) {
+        std::cerr << "Could not write " << output << "\n";
+        return 1;
+    }
+
+    double seconds = seconds_since(start);
+    std::cout << "Games       : " << games << "\n"
+              << "Positions   : " << positions << "\n"
+              << "Time (ms)   : " << std::uint64_t(seconds * 1000) << "\n"
+              << "Positions/s : " << std::uint64_t(positions / std::max(seconds, 1e-9)) << "\n";
+    return 0;
+}
+
+struct ShuffleOptions {
+    std::string temp;
+    std::uint64_t memory;
+    bool dedup;
+    std::uint64_t seed;
+    int num_threads;
+};
+
+// A bucket is held in one file per thread that wrote it
+using Bucket = std::vector<std::string>;
+
+// Records kept in memory while a bucket is deduplicated and shuffled cost their own size, a sort
+// key of hash and index and their place in the write order. Scatter passes keep every thread's
+// bucket files open together, each costing a writer and its name on top of the write buffer, so
+// their number is capped by the memory as well and oversized buckets are split again in another
+// pass.
+static const std::uint64_t BYTES_PER_RECORD =
+    sizeof(PackedPosition) + sizeof(std::pair<std::uint64_t, std::uint32_t>) +
+    sizeof(std::uint32_t);
+static const std::uint64_t BYTES_PER_BUCKET_FILE = sizeof(PackedWriter) + sizeof(std::string) + 64;
+static const int MAX_OPEN_BUCKETS = 512;
+static const std::size_t MIN_WRITE_BUFFER = 256;
+
+// Finalizer of splitmix64
+std::uint64_t mix(std::uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+// Buckets are picked by the bits of a seeded key, from the hash of the position when positions
+// are deduplicated so that all copies of one meet in the same bucket, and from the whole record
+// otherwise. Taking the top bits first, a pass which splits a bucket again reads the bits below
+// those its parents used.
+std::uint64_t record_key(const PackedPosition& packed, const ShuffleOptions& options) {
+    if (options.dedup) {
+        return mix(packed.position().hash() ^ options.seed);
+    }
+    return mix(mix(mix(packed.low ^ options.seed) ^ packed.high) ^ packed.extra ^
+               (std::uint64_t(std::uint16_t(packed.score)) << 32) ^
+               (std::uint64_t(packed.result) << 48));
+}
+
+int bucket_index(std::uint64_t key, int shift, int bits) {
+    return bits ? int((key << shift) >> (64 - bits)) : 0;
+}
+
+int ceil_log2(std::uint64_t n) {
+    int bits = 0;
+    while ((std::uint64_t(1) << bits) < n) {
+        ++bits;
+    }
+    return bits;
+}
+
+// Bits of the largest bucket count whose write buffers fit in the memory of all threads, at least
+// one so that a split always makes progress
+int max_bucket_bits(std::uint64_t memory, int num_threads) {
+    std::uint64_t buffers =
+        memory / (std::uint64_t(num_threads) *
+                  (MIN_WRITE_BUFFER * sizeof(PackedPosition) + BYTES_PER_BUCKET_FILE));
+    buffers = std::min<std::uint64_t>(buffers, std::max(MAX_OPEN_BUCKETS / num_threads, 1));
+    return std::max(ceil_log2(buffers + 1) - 1, 1);
+}
+
+std::uint64_t bucket_size(const Bucket& bucket) {
+    std::uint64_t size = 0;
+    for (const auto& path : bucket) {
+        PackedReader reader;
+        if (reader.open(path)) {
+            size += reader.size();
+        }
+    }
+    return size;
+}
+
+void remove_bucket(const Bucket& bucket) {
+    for (const auto& path : bucket) {
+        std::remove(path.c_str());
+    }
+}
+
+// One pass over the records of `sources` by `num_threads` threads, which take contiguous slices
+// and each write 2^bits bucket files of their own, so that no file is shared between threads
+std::optional<std::vector<Bucket>> scatter(const std::vector<std::string>& sources,
+                                           const std::string& prefix,
+                                           int shift,
+                                           int bits,
+                                           std::uint64_t memory,
+                                           const ShuffleOptions& options,
+                                           int num_threads) {
+    std::vector<PackedReader> readers(sources.size());
+    std::vector<std::uint64_t> offsets{0};
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        if (!readers[i].open(sources[i])) {
+            std::cerr << "Could not read " << sources[i] << "\n";
+            return {};
+        }
+        offsets.push_back(offsets.back() + readers[i].size());
+    }
+
+    int num_buckets = 1 << bits;
+    std::uint64_t file_memory = memory / (std::uint64_t(num_threads) * num_buckets);
+    std::size_t buffer_size = std::clamp<std::size_t>(
+        (file_memory - std::min(file_memory, BYTES_PER_BUCKET_FILE)) / sizeof(PackedPosition),
+        MIN_WRITE_BUFFER, PackedWriter::BUFFER_SIZE);
+    std::vector<Bucket> buckets(num_buckets);
+    for (int bucket = 0; bucket < num_buckets; ++bucket) {
+        for (int id = 0; id < num_threads; ++id) {
+            buckets[bucket].push_back(prefix + "_" + std::to_string(bucket) + "_" +
+                                      std::to_string(id) + ".tmp");
+        }
+    }
+
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> threads;
+    for (int id = 0; id < num_threads; ++id) {
+        threads.emplace_back([&, id]() {
+            std::vector<std::unique_ptr<PackedWriter>> writers;
+            for (int bucket = 0; bucket < num_buckets; ++bucket) {
+                writers.push_back(std::make_unique<PackedWriter>(buffer_size));
+                if (!writers.back()->open(buckets[bucket][id])) {
+                    failed = true;
+                    return;
+                }
+            }
+            std::uint64_t begin = offsets.back() * id / num_threads;
+            std::uint64_t end = offsets.back() * (id + 1) / num_threads;
+            for (std::size_t source = 0; source < readers.size() && !failed; ++source) {
+                std::uint64_t first = std::max(begin, offsets[source]);
+                std::uint64_t last = std::min(end, offsets[source + 1]);
+                for (std::uint64_t i = first; i < last; ++i) {
+                    const PackedPosition& packed = readers[source][i - offsets[source]];
+                    int bucket = bucket_index(record_key(packed, options), shift, bits);
+                    if (!writers[bucket]->write(packed)) {
+                        failed = true;
+                        break;
+                    }
+                }
+            }
+            for (auto& writer : writers) {
+                if (!writer->close()) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (failed) {
+        std::cerr << "Could not write the buckets of " << prefix << "\n";
+        for (const auto& bucket : buckets) {
+            remove_bucket(bucket);
+        }
+        return {};
+    }
+    return buckets;
+}
+
+// A bucket read into memory with the order to write its records in, one of each position when
+// deduplicating
+struct ShuffledBucket {
+    std::vector<PackedPosition> records;
+    std::vector<std::uint32_t> order;
+};
+
+ShuffledBucket shuffle_bucket(const Bucket& bucket,
+                              const ShuffleOptions& options,
+                              std::mt19937_64* rng) {
+    ShuffledBucket shuffled;
+    shuffled.records.reserve(bucket_size(bucket));
+    for (const auto& path : bucket) {
+        PackedReader reader;
+        if (reader.open(path)) {
+            shuffled.records.insert(shuffled.records.end(), reader.begin(), reader.end());
+        }
+    }
+
+    if (options.dedup) {
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> keys;
+        keys.reserve(shuffled.records.size());
+        for (std::size_t i = 0; i < shuffled.records.size(); ++i) {
+            keys.emplace_back(shuffled.records[i].position().hash(), std::uint32_t(i));
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end(),
+                               [](const auto& a, const auto& b) { return a.first == b.first; }),
+                   keys.end());
+        shuffled.order.reserve(keys.size());
+        for (const auto& key : keys) {
+            shuffled.order.push_back(key.second);
+        }
+    } else {
+        shuffled.order.resize(shuffled.records.size());
+        std::iota(shuffled.order.begin(), shuffled.order.end(), 0);
+    }
+    std::shuffle(shuffled.order.begin(), shuffled.order.end(), *rng);
+    return shuffled;
+}
+
+struct ShuffleProgress {
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<int> splits{0};
+};
+
+bool write_shuffled(const ShuffledBucket& shuffled,
+                    PackedWriter* writer,
+                    ShuffleProgress* progress) {
+    for (std::uint32_t index : shuffled.order) {
+        if (!writer->write(shuffled.records[index])) {
+            return false;
+        }
+    }
+    progress->written += shuffled.order.size();
+    return true;
+}
+
+// Writes a bucket too large for the memory of one thread by splitting it again on the next bits
+// of the key. Once the key runs out every record in it has the same key, which means a single
+// position when deduplicating, and the records are otherwise shuffled in chunks.
+bool write_large_bucket(const Bucket& bucket,
+                        const std::string& prefix,
+                        int shift,
+                        std::uint64_t thread_memory,
+                        const ShuffleOptions& options,
+                        std::mt19937_64* rng,
+                        PackedWriter* writer,
+                        ShuffleProgress* progress) {
+    std::uint64_t size = bucket_size(bucket);
+    if (size * BYTES_PER_RECORD <= thread_memory) {
+        bool ok = write_shuffled(shuffle_bucket(bucket, options, rng), writer, progress);
+        remove_bucket(bucket);
+        return ok;
+    }
+
+    if (shift >= 64) {
+        std::vector<PackedPosition> chunk;
+        std::size_t chunk_size = std::max<std::uint64_t>(thread_memory / sizeof(PackedPosition), 1);
+        bool ok = true;
+        for (const auto& path : bucket) {
+            PackedReader reader;
+            ok = ok && reader.open(path);
+            for (std::size_t i = 0; ok && i < reader.size(); i += chunk_size) {
+                chunk.assign(reader.begin() + i,
+                             reader.begin() + std::min(reader.size(), i + chunk_size));
+                if (options.dedup) {
+                    chunk.resize(1);
+                }
+                std::shuffle(chunk.begin(), chunk.end(), *rng);
+                ok = writer->write(chunk.data(), chunk.size());
+                progress->written += chunk.size();
+                if (options.dedup) {
+                    remove_bucket(bucket);
+                    return ok;
+                }
+            }
+        }
+        remove_bucket(bucket);
+        return ok;
+    }
+
+    int bits = std::min({ceil_log2(size * BYTES_PER_RECORD / thread_memory) + 1,
+                         max_bucket_bits(thread_memory, 1), 64 - shift});
+    auto sub_buckets = scatter(bucket, prefix, shift, bits, thread_memory, options, 1);
+    remove_bucket(bucket);
+    if (!sub_buckets) {
+        return false;
+    }
+    ++progress->splits;
+    for (std::size_t i = 0; i < sub_buckets->size(); ++i) {
+        if (!write_large_bucket((*sub_buckets)[i], prefix + "_" + std::to_string(i), shift + bits,
+                                thread_memory, options, rng, writer, progress)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Deduplicates and shuffles packed positions larger than memory in two passes. The first scatters
+// the records into buckets on disk by their key, and the second reads the buckets back one per
+// thread, keeps one record of each position, shuffles them and appends them to the output in
+// bucket order. With the keys random, the buckets take the positions in a random order too.
+int shuffle(const std::vector<std::string>& inputs,
+            const std::string& output,
+            const ShuffleOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t total = 0;
+    for (const auto& path : inputs) {
+        PackedReader reader;
+        if (!reader.open(path)) {
+            std::cerr << "Could not read " << path << "\n";
+            return 1;
+        }
+        total += reader.size();
+    }
+
+    // The output buffer is held through the second pass, next to one bucket per thread
+    std::size_t output_buffer = std::clamp<std::size_t>(
+        options.memory / 8 / sizeof(PackedPosition), MIN_WRITE_BUFFER, PackedWriter::BUFFER_SIZE);
+    std::uint64_t memory = options.memory - std::min<std::uint64_t>(
+                                                output_buffer * sizeof(PackedPosition),
+                                                options.memory);
+    std::uint64_t thread_memory = std::max<std::uint64_t>(memory / options.num_threads, 1);
+    std::uint64_t needed = (total * BYTES_PER_RECORD + thread_memory - 1) / thread_memory;
+    int bits = std::min(ceil_log2(needed) + (needed > 1),
+                        max_bucket_bits(options.memory, options.num_threads));
+    auto buckets =
+        scatter(inputs, options.temp, 0, bits, options.memory, options, options.num_threads);
+    if (!buckets) {
+        return 1;
+    }
+    double scatter_seconds = seconds_since(start);
+
+    PackedWriter writer{output_buffer};
+    if (!writer.open(output)) {
+        std::cerr << "Could not write " << output << "\n";
+        for (const auto& bucket : *buckets) {
+            remove_bucket(bucket);
+        }
+        return 1;
+    }
+
+    // Threads take the next bucket as they finish one and write it once all buckets before it
+    // are written, holding at most one shuffled bucket each
+    ShuffleProgress progress;
+    std::atomic<int> next_bucket{0};
+    std::atomic<bool> failed{false};
+    int turn = 0;
+    std::mutex turn_mutex;
+    std::condition_variable turn_changed;
+    std::vector<std::thread> threads;
+    for (int id = 0; id < options.num_threads; ++id) {
+        threads.emplace_back([&]() {
+            int bucket;
+            while ((bucket = next_bucket++) < int(buckets->size())) {
+                const Bucket& files = (*buckets)[bucket];
+                std::mt19937_64 rng{mix(options.seed ^ std::uint64_t(bucket))};
+                std::optional<ShuffledBucket> shuffled;
+                if (!failed && bucket_size(files) * BYTES_PER_RECORD <= thread_memory) {
+                    shuffled = shuffle_bucket(files, options, &rng);
+                    remove_bucket(files);
+                }
+
+                std::unique_lock<std::mutex> lock{turn_mutex};
+                turn_changed.wait(lock, [&]() { return turn == bucket; });
+                if (!failed) {
+                    std::string prefix = options.temp + "_" + std::to_string(bucket);
+                    bool ok = shuffled ? write_shuffled(*shuffled, &writer, &progress)
+                                       : write_large_bucket(files, prefix, bits, thread_memory,
+                                                            options, &rng, &writer, &progress);
+                    if (!ok) {
+                        failed = true;
+                    }
+                }
+                if (failed) {
+                    remove_bucket(files);
+                }
+                ++turn;
+                turn_changed.notify_all();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (!writer.close() || failed) {
+        std::cerr << "Could not write " << output << "\n";
+        return 1;
+    }
+
+    double seconds = seconds_since(start);
+    std::uint64_t written = progress.written;
+    std::cout << "Positions      : " << total << "\n"
+              << "Duplicates     : " << total - written << "\n"
+              << "Written        : " << written << "\n"
+              << "Buckets        : " << buckets->size() << " split again " << progress.splits
+              << "\n"
+              << "Scatter (ms)   : " << std::uint64_t(scatter_seconds * 1000) << "\n"
+              << "Shuffle (ms)   : " << std::uint64_t((seconds - scatter_seconds) * 1000) << "\n"
+              << "Time (ms)      : " << std::uint64_t(seconds * 1000) << "\n"
+              << "Positions/s    : " << std::uint64_t(total / std::max(seconds, 1e-9)) << "\n"
+              << "MB/s           : "
+              << std::uint64_t(total * sizeof(PackedPosition) / std::max(seconds, 1e-9) / 1e6)
+              << "\n";
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int num_threads = int(std::max(1U, std::thread::hardware_concurrency()));
+
+    CLI::App app{"Converts and prepares packed training positions."};
+    app.add_option("-t,--threads", num_threads, "Threads to work with.", true);
+    app.require_subcommand(1);
+
+    std::vector<std::string> convert_inputs;
+    std::string convert_output;
+    auto* convert_command = app.add_subcommand("convert", "Packs text positions with labels.");
+    convert_command->add_option("-i,--input", convert_inputs, "Text files, one FEN per line.")
+        ->required();
+    convert_command->add_option("-o,--output", convert_output, "Packed file to write.")
+        ->required();
+
+    std::vector<std::string> encode_inputs;
+    std::string encode_output;
+    auto* encode_command =
+        app.add_subcommand("encode-games", "Compresses text games into a game record file.");
+    encode_command->add_option("-i,--input", encode_inputs, "Text files, one game per line.")
+        ->required();
+    encode_command->add_option("-o,--output", encode_output, "Game record file to write.")
+        ->required();
+
+    std::vector<std::string> decode_inputs;
+    std::string decode_output;
+    bool decode_text = false;
+    auto* decode_command =
+        app.add_subcommand("decode-games", "Replays game records into packed positions.");
+    decode_command->add_option("-i,--input", decode_inputs, "Game record files.")->required();
+    decode_command->add_option("-o,--output", decode_output, "Packed file to write.")->required();
+    decode_command->add_flag("--text", decode_text, "Write the games back as text instead.");
+
+    std::vector<std::string> shuffle_inputs;
+    std::string shuffle_output;
+    ShuffleOptions shuffle_options{"", 1024, true, 0, 1};
+    bool keep_duplicates = false;
+    auto* shuffle_command = app.add_subcommand(
+        "shuffle", "Deduplicates and shuffles packed positions through buckets on disk.");
+    shuffle_command->add_option("-i,--input", shuffle_inputs, "Packed position files.")
+        ->required();
+    shuffle_command->add_option("-o,--output", shuffle_output, "Packed file to write.")
+        ->required();
+    shuffle_command->add_option("-m,--memory", shuffle_options.memory, "Memory to use in MB.",
+                                true);
+    shuffle_command->add_option("--temp", shuffle_options.temp,
+                                "Prefix of the bucket files, the output when empty.");
+    shuffle_command->add_option("--seed", shuffle_options.seed, "Seed of the shuffle.", true);
+    shuffle_command->add_flag("--keep-duplicates", keep_duplicates,
+                              "Shuffle without removing repeated positions.");
+
+    CLI11_PARSE(app, argc, argv);
+    num_threads = std::clamp(num_threads, 1, 256);
+
+    if (*convert_command) {
+        return convert(convert_inputs, convert_output, num_threads);
+    }
+    if (*shuffle_command) {
+        shuffle_options.memory = std::max<std::uint64_t>(shuffle_options.memory, 1) << 20;
+        shuffle_options.dedup = !keep_duplicates;
+        shuffle_options.num_threads = num_threads;
+        if (shuffle_options.temp.empty()) {
+            shuffle_options.temp = shuffle_output;
+        }
+        return shuffle(shuffle_inputs, shuffle_output, shuffle_options);
+    }
+    if (*encode_command) {
+        return encode_games(encode_inputs, encode_output);
+    }
+    if (*decode_command) {
+        return decode_games(decode_inputs, decode_output, decode_text);
+    }
+    return 0;
+}
@@ -1,14 +1,97 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
 #include "eval.h"
 
 namespace loltaxx {
 
+struct SideMaps {
+    explicit SideMaps(Bitboard pieces) : adjacent(pieces.adjacent()), jumps(pieces.jumps()) {
+    }
+
+    Bitboard adjacent;
+    Bitboard jumps;
+};
+
+// Frontier pieces touch an empty square and can be taken from it. Clone targets are the squares
+// reachable in a single move, jump targets the further ones only reachable in a double move.
+// Holes are the clone targets the opponent can also move into.
+PositionalTerms side_terms(Bitboard us,
+                           const SideMaps& us_maps,
+                           const SideMaps& them_maps,
+                           Bitboard empty,
+                           Bitboard empty_adjacent) {
+    Bitboard clones = us_maps.adjacent & empty;
+    Bitboard jumps = us_maps.jumps & empty & ~us_maps.adjacent;
+    Bitboard frontier = us & empty_adjacent;
+    Bitboard holes = clones & (them_maps.adjacent | them_maps.jumps);
+    return PositionalTerms{clones.popcount(), jumps.popcount(), frontier.popcount(),
+                           holes.popcount()};
+}
+
+// Squares sharing a piece-square value, of which the table has at most one per symmetry class
+struct SquareGroups {
+    std::array<int, 49> values{};
+    std::array<Bitboard::value_type, 49> masks{};
+    int size = 0;
+};
+
+constexpr SquareGroups square_groups() {
+    SquareGroups groups{};
+    for (int sq = 0; sq < 49; ++sq) {
+        int value = constants::PIECE_SQUARE_VALUES[sq];
+        if (value == 0) {
+            continue;
+        }
+        int group = 0;
+        while (group < groups.size && groups.values[group] != value) {
+            ++group;
+        }
+        if (group == groups.size) {
+            groups.values[group] = value;
+            ++groups.size;
+        }
+        groups.masks[group] |= Bitboard::value_type(1) << sq;
+    }
+    return groups;
+}
+
+constexpr SquareGroups SQUARE_GROUPS = square_groups();
+
+// Sum of the piece-square values of the crosses minus those of the knots. Only the positional
+// eval wants it, so it is counted here with a popcount per group instead of being kept up to
+// date in make_move.
+int psqt(Bitboard crosses, Bitboard knots) {
+    int psqt = 0;
+    for (int group = 0; group < SQUARE_GROUPS.size; ++group) {
+        Bitboard squares{SQUARE_GROUPS.masks[group]};
+        psqt += SQUARE_GROUPS.values[group] *
+                ((crosses & squares).popcount() - (knots & squares).popcount());
+    }
+    return psqt;
+}
+
+int side_eval(const PositionalTerms& terms) {
+    return constants::CLONE_MOBILITY_BONUS * terms.clones +
+           constants::JUMP_MOBILITY_BONUS * terms.jumps -
+           constants::FRONTIER_PENALTY * terms.frontier - constants::HOLE_PENALTY * terms.holes;
+}
+
 int eval(Position* pos) {
     int eval = 0;
 
     Bitboard crosses = pos->pieces(constants::CROSS);
     Bitboard knots = pos->pieces(constants::KNOT);
+    Bitboard empty = pos->empty_squares();
 
-    eval += 1000 * (crosses.popcount() - knots.popcount());
+    eval += PIECE_VALUE * (crosses.popcount() - knots.popcount());
+    eval += psqt(crosses, knots);
+    SideMaps cross_maps{crosses};
+    SideMaps knot_maps{knots};
+    Bitboard empty_adjacent = empty.adjacent();
+    eval += side_eval(side_terms(crosses, cross_maps, knot_maps, empty, empty_adjacent)) -
+            side_eval(side_terms(knots, knot_maps, cross_maps, empty, empty_adjacent));
 
     if (pos->side_to_move() == constants::KNOT) {
         eval = -eval;
@@ -17,4 +100,14 @@ int eval(Position* pos) {
     return eval;
 }
 
+int material_eval(Position* pos) {
+    int eval = PIECE_VALUE * (pos->pieces(constants::CROSS).popcount() -
+                              pos->pieces(constants::KNOT).popcount());
+    return pos->side_to_move() == constants::KNOT ? -eval : eval;
+}
+
+PositionalTerms positional_terms(Bitboard us, Bitboard them, Bitboard empty) {
+    return side_terms(us, SideMaps{us}, SideMaps{them}, empty, empty.adjacent());
+}
+
 }  // namespace loltaxx
@@ -1,11 +1,28 @@
 #ifndef LOLTAXX_BITBOARD_H
 #define LOLTAXX_BITBOARD_H
 
+#include "internal/eval_params.h"
+
 #include "position.h"
 
 namespace loltaxx {
 
+// Also the scale of the pattern weights, which are tuned on top of material
+static const int PIECE_VALUE = 1000;
+
+// Counts behind the positional terms of eval() for one side, weighed by the constants in
+// internal/eval_params.h
+struct PositionalTerms {
+    int clones;
+    int jumps;
+    int frontier;
+    int holes;
+};
+extern PositionalTerms positional_terms(Bitboard us, Bitboard them, Bitboard empty);
+
 extern int eval(Position* pos);
+// The piece difference alone, which decides the game once it is over
+extern int material_eval(Position* pos);
 
 }  // namespace loltaxx
 
@@ -0,0 +1,82 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "CLI11/CLI11.hpp"
+
+#include "eval.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define LOLTAXX_HAS_RDTSC 1
+#endif
+
+using loltaxx::Move;
+using loltaxx::MoveList;
+using loltaxx::Position;
+
+// The evaluation runs at every leaf, this many timestamp counter cycles per call on average is
+// the most it may take
+static const double EVAL_CYCLE_BUDGET = 100.0;
+
+std::vector<Position> random_positions(int count, std::uint64_t seed) {
+    std::mt19937_64 rng{seed};
+    std::vector<Position> positions;
+    while (int(positions.size()) < count) {
+        Position pos{loltaxx::constants::STARTPOS_FEN};
+        for (int ply = 0; ply < 200 && int(positions.size()) < count; ++ply) {
+            MoveList move_list = pos.legal_moves();
+            if (move_list.empty()) {
+                break;
+            }
+            pos.make_move(move_list[int(rng() % move_list.size())]);
+            positions.push_back(pos);
+        }
+    }
+    return positions;
+}
+
+int main(int argc, char** argv) {
+    int num_positions = 4096;
+    int iterations = 200;
+    std::uint64_t seed = 1;
+
+    CLI::App app{"Measures the average cost of one evaluation."};
+    app.add_option("-p,--positions", num_positions, "Positions from random games.", true);
+    app.add_option("-i,--iterations", iterations, "Passes over the positions.", true);
+    app.add_option("--seed", seed, "Seed for the random games.", true);
+    CLI11_PARSE(app, argc, argv);
+
+    auto positions = random_positions(std::max(1, num_positions), seed);
+    iterations = std::max(1, iterations);
+
+    // The sum keeps the calls from being optimised away
+    long long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+#ifdef LOLTAXX_HAS_RDTSC
+    unsigned long long start_cycles = __rdtsc();
+#endif
+    for (int i = 0; i < iterations; ++i) {
+        for (auto& pos : positions) {
+            sum += loltaxx::eval(&pos);
+        }
+    }
+#ifdef LOLTAXX_HAS_RDTSC
+    unsigned long long cycles = __rdtsc() - start_cycles;
+#endif
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+                                                            start);
+
+    double calls = double(iterations) * positions.size();
+    std::cout << "Evaluations : " << std::uint64_t(calls) << "\n"
+              << "ns/eval     : " << elapsed.count() / calls << "\n"
+              << "Checksum    : " << sum << "\n";
+#ifdef LOLTAXX_HAS_RDTSC
+    double cycles_per_eval = cycles / calls;
+    std::cout << "cycles/eval : " << cycles_per_eval << " (budget " << EVAL_CYCLE_BUDGET << ")\n";
+    return cycles_per_eval <= EVAL_CYCLE_BUDGET ? 0 : 1;
+#else
+    return 0;
+#endif
+}
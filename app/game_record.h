@@ -0,0 +1,561 @@
+#ifndef LOLTAXX_GAME_RECORD_H
+#define LOLTAXX_GAME_RECORD_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "packed_position.h"
+#include "position.h"
+
+namespace loltaxx {
+
+// A played game, from its start position to its last move
+struct GameRecord {
+    Position start{constants::STARTPOS_FEN};
+    std::vector<Move> moves;
+    PackedPosition::Result result = PackedPosition::DRAW;
+};
+
+namespace game_record {
+
+// Moves are stored as their rank in the legal moves ordered the way the search orders them,
+// captures and clones first, so that the moves played mostly take the first few ranks. Ties keep
+// the order of generation.
+static const int MAX_RANK_KEY = 17;
+
+// The number of enemy pieces next to every square at once, as the four bit planes of a counter
+// that each neighbouring piece is added into, so ranking a move costs four bit tests
+class CaptureCounts {
+   public:
+    explicit CaptureCounts(Bitboard them) {
+        Bitboard north = them.north();
+        Bitboard south = them.south();
+        for (Bitboard neighbours : {north, south, them.east(), them.west(), north.east(),
+                                    north.west(), south.east(), south.west()}) {
+            Bitboard carry = neighbours;
+            for (Bitboard& plane : planes_) {
+                Bitboard next = plane & carry;
+                plane ^= carry;
+                carry = next;
+            }
+        }
+    }
+
+    [[nodiscard]] int operator[](Square sq) const {
+        return int((std::uint64_t(planes_[0]) >> sq.value()) & 1) |
+               int((std::uint64_t(planes_[1]) >> sq.value()) & 1) << 1 |
+               int((std::uint64_t(planes_[2]) >> sq.value()) & 1) << 2 |
+               int((std::uint64_t(planes_[3]) >> sq.value()) & 1) << 3;
+    }
+
+   private:
+    Bitboard planes_[4]{};
+};
+
+[[nodiscard]] inline int rank_key(Move move, const CaptureCounts& captures) {
+    return 2 * captures[move.to_square()] + (move.from_square() == move.to_square());
+}
+
+[[nodiscard]] inline int move_rank(const MoveList& legal_moves, Move move, Bitboard them) {
+    CaptureCounts captures{them};
+    int key = rank_key(move, captures);
+    int rank = 0;
+    for (int i = 0; i < legal_moves.size() && legal_moves[i] != move; ++i) {
+        rank += rank_key(legal_moves[i], captures) >= key;
+    }
+    for (int i = legal_moves.size() - 1; i >= 0 && legal_moves[i] != move; --i) {
+        rank += rank_key(legal_moves[i], captures) > key;
+    }
+    return rank;
+}
+
+[[nodiscard]] inline Move ranked_move(const MoveList& legal_moves, int rank, Bitboard them) {
+    CaptureCounts captures{them};
+    std::uint8_t keys[256];
+    int counts[MAX_RANK_KEY + 1]{};
+    for (int i = 0; i < legal_moves.size(); ++i) {
+        keys[i] = std::uint8_t(rank_key(legal_moves[i], captures));
+        ++counts[keys[i]];
+    }
+    int key = MAX_RANK_KEY;
+    for (; key > 0 && rank >= counts[key]; --key) {
+        rank -= counts[key];
+    }
+    for (int i = 0; i < legal_moves.size(); ++i) {
+        if (keys[i] == key && rank-- == 0) {
+            return legal_moves[i];
+        }
+    }
+    return legal_moves[0];
+}
+
+// Binary adaptive range coder as in LZMA, with 11-bit probabilities of a zero which move 1/32 of
+// the way towards each coded bit
+static const int PROBABILITY_BITS = 11;
+static const std::uint16_t PROBABILITY_INIT = 1 << (PROBABILITY_BITS - 1);
+static const int ADAPTATION_SHIFT = 5;
+static const std::uint32_t RANGE_TOP = 1 << 24;
+
+class RangeEncoder {
+   public:
+    explicit RangeEncoder(std::vector<std::uint8_t>* output) : output_(output) {
+    }
+
+    void encode_bit(std::uint16_t* probability, int bit) {
+        std::uint32_t bound = (range_ >> PROBABILITY_BITS) * *probability;
+        if (bit) {
+            low_ += bound;
+            range_ -= bound;
+            *probability -= *probability >> ADAPTATION_SHIFT;
+        } else {
+            range_ = bound;
+            *probability += ((1 << PROBABILITY_BITS) - *probability) >> ADAPTATION_SHIFT;
+        }
+        while (range_ < RANGE_TOP) {
+            range_ <<= 8;
+            shift_low();
+        }
+    }
+    // Bits which are about as likely to be set as not, coded without a model
+    void encode_direct(std::uint32_t value, int bits) {
+        for (int bit = bits - 1; bit >= 0; --bit) {
+            range_ >>= 1;
+            if ((value >> bit) & 1) {
+                low_ += range_;
+            }
+            while (range_ < RANGE_TOP) {
+                range_ <<= 8;
+                shift_low();
+            }
+        }
+    }
+    void finish() {
+        for (int i = 0; i < 5; ++i) {
+            shift_low();
+        }
+    }
+
+   private:
+    // The top byte is held back while a carry out of the low bits could still change it
+    void shift_low() {
+        if (std::uint32_t(low_) < 0xff000000 || (low_ >> 32) != 0) {
+            std::uint8_t carry = std::uint8_t(low_ >> 32);
+            std::uint8_t byte = cache_;
+            do {
+                output_->push_back(std::uint8_t(byte + carry));
+                byte = 0xff;
+            } while (--cache_size_ != 0);
+            cache_ = std::uint8_t(low_ >> 24);
+        }
+        ++cache_size_;
+        low_ = (low_ & 0x00ffffff) << 8;
+    }
+
+    std::vector<std::uint8_t>* output_;
+    std::uint64_t low_ = 0;
+    std::uint32_t range_ = 0xffffffff;
+    std::uint8_t cache_ = 0;
+    std::uint64_t cache_size_ = 1;
+};
+
+class RangeDecoder {
+   public:
+    RangeDecoder(const std::uint8_t* data, std::size_t size) : data_(data), end_(data + size) {
+        for (int i = 0; i < 5; ++i) {
+            code_ = (code_ << 8) | next_byte();
+        }
+    }
+
+    int decode_bit(std::uint16_t* probability) {
+        std::uint32_t bound = (range_ >> PROBABILITY_BITS) * *probability;
+        int bit;
+        if (code_ < bound) {
+            range_ = bound;
+            *probability += ((1 << PROBABILITY_BITS) - *probability) >> ADAPTATION_SHIFT;
+            bit = 0;
+        } else {
+            code_ -= bound;
+            range_ -= bound;
+            *probability -= *probability >> ADAPTATION_SHIFT;
+            bit = 1;
+        }
+        while (range_ < RANGE_TOP) {
+            range_ <<= 8;
+            code_ = (code_ << 8) | next_byte();
+        }
+        return bit;
+    }
+    std::uint32_t decode_direct(int bits) {
+        std::uint32_t value = 0;
+        for (int bit = 0; bit < bits; ++bit) {
+            range_ >>= 1;
+            std::uint32_t set = code_ >= range_;
+            code_ -= range_ & (0 - set);
+            value = (value << 1) | set;
+            while (range_ < RANGE_TOP) {
+                range_ <<= 8;
+                code_ = (code_ << 8) | next_byte();
+            }
+        }
+        return value;
+    }
+
+    // Reading past the end, which only a damaged block does, yields zeroes
+    [[nodiscard]] bool overrun() const noexcept {
+        return overrun_ > 4;
+    }
+
+   private:
+    std::uint8_t next_byte() {
+        if (data_ == end_) {
+            ++overrun_;
+            return 0;
+        }
+        return *data_++;
+    }
+
+    const std::uint8_t* data_;
+    const std::uint8_t* end_;
+    std::uint32_t range_ = 0xffffffff;
+    std::uint32_t code_ = 0;
+    int overrun_ = 0;
+};
+
+// Adaptive probabilities of one block of games. Ranks are coded most significant bit first down
+// a binary tree, and the number of moves as its bit length followed by the bits below the top one.
+struct Model {
+    Model() {
+        std::fill(std::begin(ranks), std::end(ranks), PROBABILITY_INIT);
+        std::fill(std::begin(lengths), std::end(lengths), PROBABILITY_INIT);
+        std::fill(std::begin(results), std::end(results), PROBABILITY_INIT);
+        standard_start = PROBABILITY_INIT;
+    }
+
+    std::uint16_t ranks[256];
+    std::uint16_t lengths[32];
+    std::uint16_t results[4];
+    std::uint16_t standard_start;
+};
+
+template <int Bits>
+void encode_tree(RangeEncoder* encoder, std::uint16_t* probabilities, int value) {
+    int node = 1;
+    for (int bit = Bits - 1; bit >= 0; --bit) {
+        int set = (value >> bit) & 1;
+        encoder->encode_bit(&probabilities[node], set);
+        node = (node << 1) | set;
+    }
+}
+
+template <int Bits>
+int decode_tree(RangeDecoder* decoder, std::uint16_t* probabilities) {
+    int node = 1;
+    for (int bit = 0; bit < Bits; ++bit) {
+        node = (node << 1) | decoder->decode_bit(&probabilities[node]);
+    }
+    return node - (1 << Bits);
+}
+
+// Longer games are refused, which also bounds what a damaged block can decode to
+static const std::uint32_t MAX_MOVES = 1 << 16;
+
+// The rank of each move of the game, or nothing if one of them is not legal
+[[nodiscard]] inline std::optional<std::vector<int>> game_ranks(const GameRecord& game) {
+    if (game.moves.size() >= MAX_MOVES) {
+        return {};
+    }
+    std::vector<int> ranks;
+    ranks.reserve(game.moves.size());
+    Position pos = game.start;
+    for (Move move : game.moves) {
+        MoveList legal_moves = pos.legal_moves();
+        if (!legal_moves.contains(move)) {
+            return {};
+        }
+        ranks.push_back(move_rank(legal_moves, move, pos.pieces(!pos.side_to_move())));
+        // A forced move, a pass, takes no bits at all
+        if (legal_moves.size() == 1) {
+            ranks.back() = -1;
+        }
+        pos.make_move(move);
+    }
+    return ranks;
+}
+
+inline void encode_game(const GameRecord& game,
+                        const std::vector<int>& ranks,
+                        Model* model,
+                        RangeEncoder* encoder) {
+    static const Position standard{constants::STARTPOS_FEN};
+    bool is_standard = game.start.hash() == standard.hash() &&
+                       game.start.halfmoves() == 0 && game.start.gaps() == standard.gaps();
+    encoder->encode_bit(&model->standard_start, is_standard);
+    if (!is_standard) {
+        PackedPosition packed = PackedPosition::pack(game.start, 0, game.result);
+        encoder->encode_direct(std::uint32_t(packed.low >> 32), 32);
+        encoder->encode_direct(std::uint32_t(packed.low), 32);
+        encoder->encode_direct(std::uint32_t(packed.high >> 32), 32);
+        encoder->encode_direct(std::uint32_t(packed.high), 32);
+        encoder->encode_direct(packed.extra, 32);
+    }
+    encode_tree<2>(encoder, model->results, game.result);
+
+    std::uint32_t length = game.moves.size() + 1;
+    int length_bits = 32 - __builtin_clz(length);
+    encode_tree<5>(encoder, model->lengths, length_bits - 1);
+    encoder->encode_direct(length, length_bits - 1);
+
+    for (int rank : ranks) {
+        if (rank >= 0) {
+            encode_tree<8>(encoder, model->ranks, rank);
+        }
+    }
+}
+
+// Decodes the next game of the block and returns false if it does not decode to legal moves
+inline bool decode_game(Model* model, RangeDecoder* decoder, GameRecord* game) {
+    static const Position standard{constants::STARTPOS_FEN};
+    if (decoder->decode_bit(&model->standard_start)) {
+        game->start = standard;
+    } else {
+        PackedPosition packed{};
+        packed.low = std::uint64_t(decoder->decode_direct(32)) << 32;
+        packed.low |= decoder->decode_direct(32);
+        packed.high = std::uint64_t(decoder->decode_direct(32)) << 32;
+        packed.high |= decoder->decode_direct(32);
+        packed.extra = decoder->decode_direct(32);
+        game->start = packed.position();
+    }
+    int result = decode_tree<2>(decoder, model->results);
+    if (result > PackedPosition::CROSS_WIN) {
+        return false;
+    }
+    game->result = PackedPosition::Result(result);
+
+    int length_bits = decode_tree<5>(decoder, model->lengths) + 1;
+    std::uint32_t length = (1u << (length_bits - 1)) | decoder->decode_direct(length_bits - 1);
+    if (length > MAX_MOVES) {
+        return false;
+    }
+
+    game->moves.clear();
+    Position pos = game->start;
+    for (std::uint32_t ply = 1; ply < length; ++ply) {
+        MoveList legal_moves = pos.legal_moves();
+        if (legal_moves.empty() || decoder->overrun()) {
+            return false;
+        }
+        Move move = legal_moves[0];
+        if (legal_moves.size() > 1) {
+            int rank = decode_tree<8>(decoder, model->ranks);
+            if (rank >= legal_moves.size()) {
+                return false;
+            }
+            move = ranked_move(legal_moves, rank, pos.pieces(!pos.side_to_move()));
+        }
+        game->moves.push_back(move);
+        pos.make_move(move);
+    }
+    return !decoder->overrun();
+}
+
+// Games are coded in blocks which each start a fresh model behind a header of their own, so that
+// files can be concatenated and blocks decoded independently
+struct BlockHeader {
+    constexpr static char MAGIC[8]{'L', 'T', 'X', 'G', 'A', 'M', 'E', '\0'};
+    constexpr static std::uint32_t VERSION = 1;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t num_games;
+    std::uint64_t payload_size;
+};
+static_assert(sizeof(BlockHeader) == 24);
+
+}  // namespace game_record
+
+// Appends games to a record file, coding one block per BLOCK_GAMES games
+class GameWriter {
+   public:
+    static const int BLOCK_GAMES = 4096;
+
+    GameWriter() = default;
+    GameWriter(const GameWriter&) = delete;
+    GameWriter& operator=(const GameWriter&) = delete;
+
+    ~GameWriter() {
+        close();
+    }
+
+    bool open(const std::string& path, bool append = false) {
+        close();
+        file_.open(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+        return bool(file_);
+    }
+    bool close() {
+        bool ok = flush();
+        if (file_.is_open()) {
+            file_.close();
+        }
+        return ok;
+    }
+
+    // Returns false if the game is refused for an illegal move or its length, or on a failed write
+    bool write(const GameRecord& game) {
+        auto ranks = game_record::game_ranks(game);
+        if (!ranks) {
+            return false;
+        }
+        game_record::encode_game(game, *ranks, &model_, &encoder_);
+        moves_ += game.moves.size();
+        if (++block_games_ >= std::uint32_t(BLOCK_GAMES)) {
+            return flush();
+        }
+        return true;
+    }
+    bool flush() {
+        if (block_games_ && file_.is_open()) {
+            encoder_.finish();
+            game_record::BlockHeader header{};
+            std::memcpy(header.magic, game_record::BlockHeader::MAGIC, sizeof(header.magic));
+            header.version = game_record::BlockHeader::VERSION;
+            header.num_games = block_games_;
+            header.payload_size = payload_.size();
+            file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file_.write(reinterpret_cast<const char*>(payload_.data()),
+                        std::streamsize(payload_.size()));
+            file_.flush();
+            bytes_ += sizeof(header) + payload_.size();
+        }
+        reset_block();
+        return !file_.is_open() || bool(file_);
+    }
+
+    // Totals over everything flushed or pending, for reporting
+    [[nodiscard]] std::uint64_t bytes() const noexcept {
+        return bytes_ + payload_.size();
+    }
+    [[nodiscard]] std::uint64_t moves() const noexcept {
+        return moves_;
+    }
+
+   private:
+    void reset_block() {
+        block_games_ = 0;
+        payload_.clear();
+        model_ = game_record::Model{};
+        encoder_ = game_record::RangeEncoder{&payload_};
+    }
+
+    std::ofstream file_;
+    std::uint32_t block_games_ = 0;
+    std::vector<std::uint8_t> payload_;
+    game_record::Model model_;
+    game_record::RangeEncoder encoder_{&payload_};
+    std::uint64_t bytes_ = 0;
+    std::uint64_t moves_ = 0;
+};
+
+// Streams the games of a record file from a read-only mapping, decoding one block at a time
+class GameReader {
+   public:
+    GameReader() = default;
+    GameReader(const GameReader&) = delete;
+    GameReader& operator=(const GameReader&) = delete;
+
+    ~GameReader() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        close();
+        return file_.open(path, true);
+    }
+    void close() {
+        file_.close();
+        offset_ = 0;
+        block_games_ = 0;
+        decoder_ = {};
+        failed_ = false;
+    }
+
+    // Decodes the next game into `game` and returns false at the end of the file or at the first
+    // damaged block, which failed() then tells apart
+    bool next(GameRecord* game) {
+        if (block_games_ == 0 && !next_block()) {
+            return false;
+        }
+        --block_games_;
+        if (!game_record::decode_game(&model_, &*decoder_, game)) {
+            failed_ = true;
+            block_games_ = 0;
+            offset_ = file_.size();
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool failed() const noexcept {
+        return failed_;
+    }
+
+   private:
+    bool next_block() {
+        const auto* data = reinterpret_cast<const std::uint8_t*>(file_.data());
+        game_record::BlockHeader header{};
+        while (block_games_ == 0) {
+            if (offset_ == file_.size()) {
+                return false;
+            }
+            if (file_.size() - offset_ < sizeof(header)) {
+                failed_ = true;
+                return false;
+            }
+            std::memcpy(&header, data + offset_, sizeof(header));
+            offset_ += sizeof(header);
+            if (std::memcmp(header.magic, game_record::BlockHeader::MAGIC, sizeof(header.magic)) !=
+                    0 ||
+                header.version != game_record::BlockHeader::VERSION ||
+                header.payload_size > file_.size() - offset_) {
+                failed_ = true;
+                offset_ = file_.size();
+                return false;
+            }
+            decoder_.emplace(data + offset_, header.payload_size);
+            offset_ += header.payload_size;
+            block_games_ = header.num_games;
+            model_ = game_record::Model{};
+        }
+        return true;
+    }
+
+    MappedFile file_;
+    std::size_t offset_ = 0;
+    std::uint32_t block_games_ = 0;
+    std::optional<game_record::RangeDecoder> decoder_;
+    game_record::Model model_;
+    bool failed_ = false;
+};
+
+// Calls `visit(pos, move)` for the position before each move of the game, then returns the
+// position after the last move
+template <typename F>
+Position replay(const GameRecord& game, F&& visit) {
+    Position pos = game.start;
+    for (Move move : game.moves) {
+        visit(static_cast<const Position&>(pos), move);
+        pos.make_move(move);
+    }
+    return pos;
+}
+
+}  // namespace loltaxx
+
+#endif  // LOLTAXX_GAME_RECORD_H
@@ -0,0 +1,29 @@
+#ifndef LOLTAXX_INTERNAL_EVAL_PARAMS_H
+#define LOLTAXX_INTERNAL_EVAL_PARAMS_H
+
+#include <array>
+
+// Parameters of the positional terms of the handcrafted eval. They are hand-set, tune --handcrafted
+// writes this file again with tuned values.
+namespace loltaxx::constants {
+
+// Pieces on the rim have fewer neighbours to be captured from. The table is the same for both
+// sides, the board looks alike from either one.
+constexpr std::array<int, 49> PIECE_SQUARE_VALUES = {
+    30, 15, 15, 15, 15, 15, 30,
+    15,  0,  0,  0,  0,  0, 15,
+    15,  0,  0,  0,  0,  0, 15,
+    15,  0,  0,  0,  0,  0, 15,
+    15,  0,  0,  0,  0,  0, 15,
+    15,  0,  0,  0,  0,  0, 15,
+    30, 15, 15, 15, 15, 15, 30,
+};
+
+constexpr int FRONTIER_PENALTY = 20;
+constexpr int CLONE_MOBILITY_BONUS = 10;
+constexpr int JUMP_MOBILITY_BONUS = 3;
+constexpr int HOLE_PENALTY = 25;
+
+}  // namespace loltaxx::constants
+
+#endif  // LOLTAXX_INTERNAL_EVAL_PARAMS_H
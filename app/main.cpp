@@ -1,27 +1,98 @@
+#include <cstdlib>
 #include <iostream>
+#include <thread>
 
+#include "CLI11/CLI11.hpp"
+
+#include "analyse.h"
+#include "bench.h"
+#include "book.h"
+#include "position_tracker.h"
 #include "search.h"
 
 using namespace loltaxx;
 
-int main() {
+int main(int argc, char** argv) {
     std::ios_base::sync_with_stdio(false);
-    std::cout.setf(std::ios::unitbuf);
 
-    Position position{constants::STARTPOS_FEN};
-    search::SearchGlobals search_globals = search::SearchGlobals::new_search_globals();
-    auto position_handler = [&position](const UAIPositionParameters& position_parameters) {
-        position = Position{position_parameters.fen()};
-        if (!position_parameters.move_list()) {
-            return;
+    if (argc > 1 && std::string{argv[1]} == "bench") {
+        int depth = argc > 2 ? std::atoi(argv[2]) : bench::DEFAULT_DEPTH;
+        int num_threads = argc > 3 ? std::atoi(argv[3]) : bench::DEFAULT_THREADS;
+        int hash_size = argc > 4 ? std::atoi(argv[4]) : bench::DEFAULT_HASH;
+        return bench::bench(std::clamp(depth, 1, search::MAX_PLY),
+                            std::clamp(num_threads, 1, 256),
+                            std::clamp(hash_size, 1, 65536));
+    }
+    if (argc > 1 && std::string{argv[1]} == "smpbench") {
+        int max_threads = argc > 2 ? std::atoi(argv[2]) : int(std::thread::hardware_concurrency());
+        int depth = argc > 3 ? std::atoi(argv[3]) : bench::DEFAULT_DEPTH + 1;
+        int runs = argc > 4 ? std::atoi(argv[4]) : bench::DEFAULT_SMP_RUNS;
+        int hash_size = argc > 5 ? std::atoi(argv[5]) : bench::DEFAULT_HASH;
+        return bench::smp_bench(std::clamp(max_threads, 1, 256),
+                                std::clamp(depth, 1, search::MAX_PLY),
+                                std::clamp(runs, 1, 1000),
+                                std::clamp(hash_size, 1, 65536));
+    }
+
+    if (argc > 1 && std::string{argv[1]} == "analyse") {
+        analyse::AnalyseOptions options{
+            "", "", {}, {}, analyse::DEFAULT_JOBS, analyse::DEFAULT_HASH, false, false, false};
+        std::string eval_file;
+        std::string pattern_file;
+        CLI::App app{"Searches every position of a file and writes the results as JSON lines."};
+        app.add_option("-i,--input", options.input, "EPD or FEN file, one position per line.")
+            ->required();
+        app.add_option("-o,--output", options.output, "File to write, standard output if empty.");
+        app.add_option("-d,--depth", options.depth, "Depth to search each position to.");
+        app.add_option("-n,--nodes", options.nodes, "Nodes to search each position for.");
+        app.add_option("-j,--jobs", options.jobs, "Positions searched at once.", true);
+        app.add_option("--hash", options.hash_size, "Hash size in MB for each job.", true);
+        app.add_flag("--shared-hash", options.shared_hash, "Share one table of that size.");
+        app.add_flag("--clear-hash", options.clear_hash,
+                     "Clear the table of each job before every position.");
+        app.add_flag("--completion-order", options.completion_order,
+                     "Write results as they finish instead of in input order.");
+        app.add_option("--eval-file", eval_file, "Network to search with.");
+        app.add_option("--pattern-file", pattern_file, "Pattern weights to search with.");
+        CLI11_PARSE(app, argc - 1, argv + 1);
+
+        if (!options.depth && !options.nodes) {
+            std::cerr << "One of --depth and --nodes is required\n";
+            return 1;
+        }
+        if (options.depth) {
+            options.depth = std::clamp(*options.depth, 1, search::MAX_PLY);
+        }
+        options.jobs = std::clamp(options.jobs, 1, 256);
+        options.hash_size = std::clamp(options.hash_size, 1, 65536);
+        if (!eval_file.empty() && !nnue::load(eval_file)) {
+            std::cerr << "Could not load " << eval_file << "\n";
+            return 1;
         }
-        for (auto& move_str : position_parameters.move_list()->move_list()) {
-            position.make_move(*Move::from(move_str));
+        if (!pattern_file.empty() && !patterns::load(pattern_file)) {
+            std::cerr << "Could not load " << pattern_file << "\n";
+            return 1;
         }
+        return analyse::analyse(options);
+    }
+
+    PositionTracker position_tracker;
+    Book book;
+    search::SearchGlobals search_globals = search::SearchGlobals::new_search_globals();
+    auto position_handler = [&position_tracker](const UAIPositionParameters& position_parameters) {
+        position_tracker.update(position_parameters);
     };
-    auto go_handler = [&position, &search_globals](const UAIGoParameters& go_parameters) {
+    auto go_handler = [&position_tracker, &book, &search_globals](
+                          const UAIGoParameters& go_parameters) {
+        // Analysis wants the search output, games take the book move without spending clock time
+        if (!go_parameters.infinite()) {
+            if (auto book_move = book.probe(position_tracker.position())) {
+                UAIService::bestmove(book_move->to_str());
+                return;
+            }
+        }
         search_globals.set_go_parameters(go_parameters);
-        auto best_move = search::best_move_search(position, &search_globals);
+        auto best_move = search::best_move_search(position_tracker.position(), &search_globals);
         if (best_move) {
             UAIService::bestmove(best_move->to_str());
         } else {
@@ -32,20 +103,91 @@ int main() {
     // auto display_handler = [&position](const std::istringstream&) { position.display(); };
 
     UAIService uai_service{"loltaxx", "Manik Charan"};
+    uai_service.register_option(UAISpinOption{
+        "Hash", 128, 1, 65536, [](int hash_size) { search::set_hash_size(hash_size); }});
+    uai_service.register_option(UAISpinOption{
+        "Threads", 1, 1, 256, [&search_globals](int num_threads) {
+            search_globals.set_num_threads(num_threads);
+        }});
+    uai_service.register_option(UAISpinOption{
+        "MultiPV", 1, 1, search::MAX_MULTIPV, [&search_globals](int multipv) {
+            search_globals.set_multipv(multipv);
+        }});
+    uai_service.register_option(UAICheckOption{
+        "NullMovePruning", true, [&search_globals](bool enabled) {
+            search_globals.set_null_move_pruning(enabled);
+        }});
+    uai_service.register_option(UAICheckOption{
+        "LateMoveReductions", true, [&search_globals](bool enabled) {
+            search_globals.set_late_move_reductions(enabled);
+        }});
+    uai_service.register_option(UAICheckOption{
+        "ReverseFutilityPruning", true, [&search_globals](bool enabled) {
+            search_globals.set_reverse_futility_pruning(enabled);
+        }});
+    uai_service.register_option(UAICheckOption{
+        "EvalCache", true, [&search_globals](bool enabled) {
+            search_globals.set_eval_cache(enabled);
+        }});
+    uai_service.register_option(UAICheckOption{
+        "PositionalEval", false, [&search_globals](bool enabled) {
+            search_globals.set_positional_eval(enabled);
+        }});
+    uai_service.register_option(UAIComboOption{
+        "SearchDriver", "PVS", {"PVS", "MTDF"}, [&search_globals](const std::string& driver) {
+            search_globals.set_driver(driver == "MTDF" ? search::SearchDriver::MTDF
+                                                       : search::SearchDriver::PVS);
+        }});
+    uai_service.register_option(UAIStringOption{"TBPath", "", [](const std::string& path) {
+        if (!search::set_tablebase_path(path)) {
+            UAILine line;
+            line << "info string could not load tablebase " << path;
+            UAIService::info(line);
+        }
+    }});
+    uai_service.register_option(UAIStringOption{"EvalFile", "", [](const std::string& path) {
+        if (path.empty() || path == "<empty>") {
+            nnue::unload();
+        } else if (!nnue::load(path)) {
+            UAILine line;
+            line << "info string could not load network " << path;
+            UAIService::info(line);
+        }
+    }});
+    uai_service.register_option(UAIStringOption{"PatternFile", "", [](const std::string& path) {
+        if (path.empty() || path == "<empty>") {
+            patterns::unload();
+        } else if (!patterns::load(path)) {
+            UAILine line;
+            line << "info string could not load patterns " << path;
+            UAIService::info(line);
+        }
+    }});
+    uai_service.register_option(UAIStringOption{"BookFile", "", [&book](const std::string& path) {
+        if (path.empty() || path == "<empty>") {
+            book.unload();
+        } else if (!book.load(path)) {
+            UAILine line;
+            line << "info string could not load book " << path;
+            UAIService::info(line);
+        }
+    }});
+    uai_service.register_option(UAISpinOption{
+        "InfoInterval", 1000, 0, 60000, [&search_globals](int info_interval) {
+            search_globals.set_info_interval(std::chrono::milliseconds{info_interval});
+        }});
     uai_service.register_position_handler(position_handler);
     uai_service.register_go_handler(go_handler);
     uai_service.register_stop_handler(stop_handler);
     // uai_service.register_handler("d", display_handler);
-    // uai_service.register_handler("tune", tune_handler);
 
     std::string line;
-    while (true) {
-        std::getline(std::cin, line);
+    while (std::getline(std::cin, line)) {
         if (line == "uai") {
             uai_service.run();
             break;
         } else {
-            std::cout << "Supported Protocols: uai\n";
+            UAIOutput::instance().write_line("Supported Protocols: uai");
         }
     }
 
@@ -0,0 +1,88 @@
+#ifndef LOLTAXX_MAPPED_FILE_H
+#define LOLTAXX_MAPPED_FILE_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace loltaxx {
+
+// A whole file mapped read-only, so engine processes on one machine share a single copy. An empty
+// file opens without a mapping.
+class MappedFile {
+   public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept {
+        *this = std::move(other);
+    }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    // Readers which stream through the file once ask for sequential read-ahead
+    bool open(const std::string& path, bool sequential = false) {
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat file_stat {};
+        if (::fstat(fd, &file_stat) < 0) {
+            ::close(fd);
+            return false;
+        }
+        std::size_t size = file_stat.st_size;
+        if (size == 0) {
+            ::close(fd);
+            return true;
+        }
+        void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        if (sequential) {
+            ::madvise(data, size, MADV_SEQUENTIAL);
+        }
+
+        data_ = data;
+        size_ = size;
+        return true;
+    }
+    void close() {
+        if (data_) {
+            ::munmap(data_, size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    [[nodiscard]] const char* data() const noexcept {
+        return static_cast<const char*>(data_);
+    }
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_;
+    }
+
+   private:
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}  // namespace loltaxx
+
+#endif  // LOLTAXX_MAPPED_FILE_H
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <optional>
+#include <string_view>
 #include <vector>
 
 #include "square.h"
@@ -30,10 +31,10 @@ class Move {
         : value_(square.value() | (square.value() << TO_SQUARE_SHIFT)) {
     }
 
-    static std::optional<Move> from(const std::string& str) {
+    constexpr static std::optional<Move> from(std::string_view str) {
         auto strlen = str.length();
         if (strlen == 2) {
-            auto piece_sq = Square::from(str.substr(0, 2));
+            auto piece_sq = Square::from(str[0], str[1]);
             if (!piece_sq) {
                 return std::nullopt;
             }
@@ -44,8 +45,8 @@ class Move {
                 return Move{Square{49}};
             }
 
-            auto from = Square::from(str.substr(0, 2));
-            auto to = Square::from(str.substr(2, 4));
+            auto from = Square::from(str[0], str[1]);
+            auto to = Square::from(str[2], str[3]);
             if (!(from && to)) {
                 return std::nullopt;
             }
@@ -71,6 +72,26 @@ class Move {
         return move_str;
     }
 
+    // Writes the move into `buffer` without allocating and returns the number of characters written
+    int to_chars(char* buffer) const {
+        Square from_sq = from_square();
+        if (from_sq == constants::SQUARE_NULL) {
+            std::fill(buffer, buffer + 4, '0');
+            return 4;
+        }
+
+        buffer[0] = from_sq.file().to_char();
+        buffer[1] = from_sq.rank().to_char();
+        Square to_sq = to_square();
+        if (from_sq == to_sq) {
+            return 2;
+        }
+
+        buffer[2] = to_sq.file().to_char();
+        buffer[3] = to_sq.rank().to_char();
+        return 4;
+    }
+
     [[nodiscard]] constexpr bool operator==(const Move rhs) const {
         return value() == rhs.value();
     }
@@ -128,12 +149,12 @@ class MoveList {
         values_[size_] = move;
         ++size_;
     }
-    constexpr void add(MoveList move_list) {
-        for (Move move : move_list) {
+    constexpr void add(const MoveList& move_list) {
+        for (int i = 0; i < move_list.size(); ++i) {
             if (size_ >= MAX_SIZE) {
                 break;
             }
-            add(move);
+            add(move_list[i]);
         }
     }
     constexpr void clear() {
@@ -0,0 +1,131 @@
+#include "nnue.h"
+
+#if defined(__AVX2__) || defined(__AVX512VNNI__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+
+#include "weight_file.h"
+
+namespace loltaxx::nnue {
+
+namespace {
+
+const weight_file::Format FORMAT{
+    {'L', 'T', 'X', 'N', 'N', 'U', 'E', '\0'}, 1, {INPUTS, HIDDEN, L1, L2}};
+
+bool network_loaded = false;
+
+std::uint8_t clip(std::int32_t value) {
+    return std::uint8_t(std::clamp(value, 0, FT_CLIP));
+}
+
+template <int Inputs, int Outputs>
+void affine(const std::uint8_t* input,
+            const std::int8_t (&weights)[Outputs][Inputs],
+            const std::int32_t* biases,
+            std::uint8_t* output) {
+    for (int i = 0; i < Outputs; ++i) {
+        output[i] = clip((biases[i] + dot(input, weights[i], Inputs)) >> WEIGHT_SHIFT);
+    }
+}
+
+}  // namespace
+
+Network network;
+
+bool load(const std::string& path) {
+    if (!weight_file::load(path, FORMAT, &network, sizeof(Network))) {
+        return false;
+    }
+    network_loaded = true;
+    return true;
+}
+
+bool write(const std::string& path) {
+    return weight_file::write(path, FORMAT, &network, sizeof(Network));
+}
+
+void unload() {
+    network_loaded = false;
+}
+
+bool loaded() noexcept {
+    return network_loaded;
+}
+
+void refresh(const Position& pos, Accumulator* acc) {
+    for (Piece side : constants::PIECES) {
+        std::int16_t* values = acc->values[side];
+        std::copy(network.ft_biases, network.ft_biases + HIDDEN, values);
+        for (Square sq : Bitboard::Iterator{pos.pieces(side)}) {
+            add_feature(values, own_feature(sq));
+        }
+        for (Square sq : Bitboard::Iterator{pos.pieces(!side)}) {
+            add_feature(values, their_feature(sq));
+        }
+        for (Square sq : Bitboard::Iterator{pos.gaps()}) {
+            add_feature(values, gap_feature(sq));
+        }
+    }
+}
+
+int evaluate(const Accumulator& acc, Piece side_to_move) {
+    alignas(64) std::uint8_t input[2 * HIDDEN];
+    alignas(64) std::uint8_t hidden1[L1];
+    alignas(64) std::uint8_t hidden2[L2];
+
+    const std::int16_t* us = acc.values[side_to_move];
+    const std::int16_t* them = acc.values[!side_to_move];
+    for (int i = 0; i < HIDDEN; ++i) {
+        input[i] = clip(us[i]);
+        input[HIDDEN + i] = clip(them[i]);
+    }
+
+    affine(input, network.l1_weights, network.l1_biases, hidden1);
+    affine(hidden1, network.l2_weights, network.l2_biases, hidden2);
+    return (network.out_bias + dot(hidden2, network.out_weights, L2)) >> OUTPUT_SHIFT;
+}
+
+std::int32_t dot_scalar(const std::uint8_t* input, const std::int8_t* weights, int size) {
+    std::int32_t sum = 0;
+    for (int i = 0; i < size; ++i) {
+        sum += std::int32_t(input[i]) * weights[i];
+    }
+    return sum;
+}
+
+// Activations are at most 127 and weights at least -128, so the pairwise int16 sums of
+// maddubs cannot saturate
+std::int32_t dot(const std::uint8_t* input, const std::int8_t* weights, int size) {
+    int i = 0;
+    std::int32_t sum = 0;
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+    __m512i sum512 = _mm512_setzero_si512();
+    for (; i + 64 <= size; i += 64) {
+        __m512i in = _mm512_loadu_si512(input + i);
+        __m512i w = _mm512_loadu_si512(weights + i);
+        sum512 = _mm512_dpbusd_epi32(sum512, in, w);
+    }
+    sum += _mm512_reduce_add_epi32(sum512);
+#endif
+#if defined(__AVX2__)
+    __m256i sum256 = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (; i + 32 <= size; i += 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        __m256i products = _mm256_madd_epi16(_mm256_maddubs_epi16(in, w), ones);
+        sum256 = _mm256_add_epi32(sum256, products);
+    }
+    __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum256),
+                                   _mm256_extracti128_si256(sum256, 1));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum += _mm_cvtsi128_si32(sum128);
+#endif
+    return sum + dot_scalar(input + i, weights + i, size - i);
+}
+
+}  // namespace loltaxx::nnue
@@ -0,0 +1,117 @@
+#ifndef LOLTAXX_NNUE_H
+#define LOLTAXX_NNUE_H
+
+#include <cstdint>
+#include <string>
+
+#include "position.h"
+
+namespace loltaxx::nnue {
+
+// Each side sees the board through its own features: its pieces, the opponent's pieces and the
+// gaps, one per square. Both perspectives share the feature transformer weights.
+constexpr int SQUARES = 49;
+constexpr int INPUTS = 3 * SQUARES;
+constexpr int HIDDEN = 128;
+constexpr int L1 = 32;
+constexpr int L2 = 32;
+
+// Activations are clipped to [0, FT_CLIP] and stored as bytes. Layer sums are shifted down by
+// WEIGHT_SHIFT before the next clip, and the output by OUTPUT_SHIFT into eval units.
+constexpr int FT_CLIP = 127;
+constexpr int WEIGHT_SHIFT = 6;
+constexpr int OUTPUT_SHIFT = 4;
+
+struct alignas(64) Accumulator {
+    std::int16_t values[2][HIDDEN];
+};
+
+struct alignas(64) Network {
+    std::int16_t ft_weights[INPUTS][HIDDEN];
+    std::int16_t ft_biases[HIDDEN];
+    alignas(64) std::int8_t l1_weights[L1][2 * HIDDEN];
+    std::int32_t l1_biases[L1];
+    alignas(64) std::int8_t l2_weights[L2][L1];
+    std::int32_t l2_biases[L2];
+    alignas(64) std::int8_t out_weights[L2];
+    std::int32_t out_bias;
+};
+
+extern Network network;
+
+extern bool load(const std::string& path);
+extern bool write(const std::string& path);
+extern void unload();
+[[nodiscard]] extern bool loaded() noexcept;
+
+// Fills in both perspectives from scratch, done once at the root of each search
+extern void refresh(const Position& pos, Accumulator* acc);
+// Score for the side to move, in eval units
+[[nodiscard]] extern int evaluate(const Accumulator& acc, Piece side_to_move);
+
+// Dot product of clipped activations with one row of int8 weights, size is a multiple of 32
+[[nodiscard]] extern std::int32_t dot(const std::uint8_t* input,
+                                      const std::int8_t* weights,
+                                      int size);
+[[nodiscard]] extern std::int32_t dot_scalar(const std::uint8_t* input,
+                                             const std::int8_t* weights,
+                                             int size);
+
+constexpr int own_feature(Square sq) {
+    return sq;
+}
+constexpr int their_feature(Square sq) {
+    return SQUARES + sq;
+}
+constexpr int gap_feature(Square sq) {
+    return 2 * SQUARES + sq;
+}
+
+inline void add_feature(std::int16_t* values, int feature) {
+    const std::int16_t* row = network.ft_weights[feature];
+    for (int i = 0; i < HIDDEN; ++i) {
+        values[i] += row[i];
+    }
+}
+inline void sub_feature(std::int16_t* values, int feature) {
+    const std::int16_t* row = network.ft_weights[feature];
+    for (int i = 0; i < HIDDEN; ++i) {
+        values[i] -= row[i];
+    }
+}
+
+// Applies a move to the parent's accumulator from the squares make_move changes: the target
+// square, the vacated one for a jump, and the captured pieces, which change owner in both views.
+// Must be called with the position before the move is made.
+template <Piece::Value::ColorValue Us>
+void update(const Position& pos, Move move, const Accumulator& parent, Accumulator* child) {
+    constexpr Piece::Value::ColorValue Them = Us == constants::CROSS ? Piece::Value::KNOT
+                                                                     : Piece::Value::CROSS;
+    *child = parent;
+    if (move == constants::MOVE_NULL) {
+        return;
+    }
+
+    Square from = move.from_square();
+    Square to = move.to_square();
+    Bitboard captured = Bitboard{to}.adjacent() & pos.pieces(Piece{Them});
+
+    std::int16_t* us = child->values[Us];
+    std::int16_t* them = child->values[Them];
+    add_feature(us, own_feature(to));
+    add_feature(them, their_feature(to));
+    if (from != to) {
+        sub_feature(us, own_feature(from));
+        sub_feature(them, their_feature(from));
+    }
+    for (Square sq : Bitboard::Iterator{captured}) {
+        sub_feature(us, their_feature(sq));
+        add_feature(us, own_feature(sq));
+        sub_feature(them, own_feature(sq));
+        add_feature(them, their_feature(sq));
+    }
+}
+
+}  // namespace loltaxx::nnue
+
+#endif  // LOLTAXX_NNUE_H
@@ -0,0 +1,210 @@
+#ifndef LOLTAXX_PACKED_POSITION_H
+#define LOLTAXX_PACKED_POSITION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "position.h"
+
+namespace loltaxx {
+
+// A labelled training position in 24 bytes. The crosses, the knots and the gaps take 49 bits each
+// and are split across the two words and the low 19 bits of extra, followed by the side to move
+// and the halfmove clock. The score is the search score for the side to move and the result is
+// the game result for crosses: 0 for a loss, 1 for a draw and 2 for a win.
+struct PackedPosition {
+    constexpr static int MAX_SCORE = 32000;
+
+    enum Result : std::uint8_t
+    {
+        CROSS_LOSS = 0,
+        DRAW = 1,
+        CROSS_WIN = 2,
+    };
+
+    std::uint64_t low;
+    std::uint64_t high;
+    std::uint32_t extra;
+    std::int16_t score;
+    std::uint8_t result;
+    std::uint8_t reserved;
+
+    [[nodiscard]] static PackedPosition pack(const Position& pos, int score, Result result) {
+        std::uint64_t crosses = pos.pieces(constants::CROSS);
+        std::uint64_t knots = pos.pieces(constants::KNOT);
+        std::uint64_t gaps = pos.gaps();
+        int halfmoves = std::clamp(pos.halfmoves(), 0, 127);
+
+        PackedPosition packed{};
+        packed.low = crosses | (knots << 49);
+        packed.high = (knots >> 15) | (gaps << 34);
+        packed.extra = std::uint32_t(gaps >> 30) |
+                       (std::uint32_t(pos.side_to_move() == constants::KNOT) << 19) |
+                       (std::uint32_t(halfmoves) << 20);
+        packed.score = std::int16_t(std::clamp(score, -MAX_SCORE, MAX_SCORE));
+        packed.result = result;
+        return packed;
+    }
+
+    [[nodiscard]] Bitboard crosses() const noexcept {
+        return Bitboard{low} & Bitboard::full();
+    }
+    [[nodiscard]] Bitboard knots() const noexcept {
+        return Bitboard{(low >> 49) | (high << 15)} & Bitboard::full();
+    }
+    [[nodiscard]] Bitboard gaps() const noexcept {
+        return Bitboard{(high >> 34) | (std::uint64_t(extra) << 30)} & Bitboard::full();
+    }
+    [[nodiscard]] Piece side_to_move() const noexcept {
+        return (extra >> 19) & 1 ? constants::KNOT : constants::CROSS;
+    }
+    [[nodiscard]] int halfmoves() const noexcept {
+        return int(extra >> 20) & 127;
+    }
+
+    [[nodiscard]] Position position() const {
+        return Position::from_packed(*this);
+    }
+};
+static_assert(sizeof(PackedPosition) == 24);
+
+inline Position Position::from_packed(const PackedPosition& packed) {
+    Position pos;
+    pos.piece_bb_[constants::CROSS] = packed.crosses();
+    pos.piece_bb_[constants::KNOT] = packed.knots();
+    pos.gaps_ = packed.gaps();
+    pos.side_to_move_ = packed.side_to_move();
+    pos.halfmoves_ = packed.halfmoves();
+    pos.hash_ = pos.calculate_hash();
+    return pos;
+}
+
+// Read-only view of a file of packed positions, which are used in place from the mapping.
+// Files have no header, so shards can be concatenated.
+class PackedReader {
+   public:
+    PackedReader() = default;
+    PackedReader(const PackedReader&) = delete;
+    PackedReader& operator=(const PackedReader&) = delete;
+    PackedReader(PackedReader&& other) noexcept {
+        *this = std::move(other);
+    }
+    PackedReader& operator=(PackedReader&& other) noexcept {
+        std::swap(file_, other.file_);
+        std::swap(positions_, other.positions_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+
+    ~PackedReader() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        close();
+        // Readers mostly stream through the file once
+        if (!file_.open(path, true) || file_.size() % sizeof(PackedPosition) != 0) {
+            file_.close();
+            return false;
+        }
+
+        positions_ = reinterpret_cast<const PackedPosition*>(file_.data());
+        size_ = file_.size() / sizeof(PackedPosition);
+        return true;
+    }
+    void close() {
+        file_.close();
+        positions_ = nullptr;
+        size_ = 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_;
+    }
+    [[nodiscard]] const PackedPosition& operator[](std::size_t index) const noexcept {
+        return positions_[index];
+    }
+    [[nodiscard]] const PackedPosition* begin() const noexcept {
+        return positions_;
+    }
+    [[nodiscard]] const PackedPosition* end() const noexcept {
+        return positions_ + size_;
+    }
+
+   private:
+    MappedFile file_;
+    const PackedPosition* positions_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Appends packed positions to a file through a buffer, one write per buffer of BUFFER_SIZE
+// positions unless a smaller one is asked for
+class PackedWriter {
+   public:
+    static const int BUFFER_SIZE = 1 << 16;
+
+    explicit PackedWriter(std::size_t buffer_size = BUFFER_SIZE)
+        : buffer_size_(std::max<std::size_t>(buffer_size, 1)) {
+        buffer_.reserve(buffer_size_);
+        // Only whole buffers are written, a stream buffer of its own would just add a copy and
+        // memory to every open bucket file of a shuffle
+        file_.rdbuf()->pubsetbuf(nullptr, 0);
+    }
+    PackedWriter(const PackedWriter&) = delete;
+    PackedWriter& operator=(const PackedWriter&) = delete;
+
+    ~PackedWriter() {
+        close();
+    }
+
+    bool open(const std::string& path, bool append = false) {
+        close();
+        file_.open(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+        return bool(file_);
+    }
+    bool close() {
+        bool ok = flush();
+        if (file_.is_open()) {
+            file_.close();
+        }
+        return ok;
+    }
+
+    bool write(const PackedPosition& position) {
+        buffer_.push_back(position);
+        if (buffer_.size() >= buffer_size_) {
+            return flush();
+        }
+        return true;
+    }
+    bool write(const PackedPosition* positions, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!write(positions[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool flush() {
+        if (!buffer_.empty() && file_.is_open()) {
+            file_.write(reinterpret_cast<const char*>(buffer_.data()),
+                        std::streamsize(buffer_.size() * sizeof(PackedPosition)));
+            file_.flush();
+        }
+        buffer_.clear();
+        return !file_.is_open() || bool(file_);
+    }
+
+   private:
+    std::size_t buffer_size_;
+    std::ofstream file_;
+    std::vector<PackedPosition> buffer_;
+};
+
+}  // namespace loltaxx
+
+#endif  // LOLTAXX_PACKED_POSITION_H
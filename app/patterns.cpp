@@ -0,0 +1,38 @@
+#include "patterns.h"
+
+#include "weight_file.h"
+
+namespace loltaxx::patterns {
+
+namespace {
+
+const weight_file::Format FORMAT{
+    {'L', 'T', 'X', 'P', 'A', 'T', 'T', '\0'}, 1, {NUM_PATTERNS, NUM_WEIGHTS}};
+
+bool patterns_loaded = false;
+
+}  // namespace
+
+std::int16_t weights[NUM_WEIGHTS];
+
+bool load(const std::string& path) {
+    if (!weight_file::load(path, FORMAT, weights, sizeof(weights))) {
+        return false;
+    }
+    patterns_loaded = true;
+    return true;
+}
+
+bool write(const std::string& path) {
+    return weight_file::write(path, FORMAT, weights, sizeof(weights));
+}
+
+void unload() {
+    patterns_loaded = false;
+}
+
+bool loaded() noexcept {
+    return patterns_loaded;
+}
+
+}  // namespace loltaxx::patterns
@@ -0,0 +1,192 @@
+#ifndef LOLTAXX_PATTERNS_H
+#define LOLTAXX_PATTERNS_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "position.h"
+
+namespace loltaxx::patterns {
+
+// N-tuple patterns over the rows, the columns, the two long diagonals and the 3x3 corner blocks.
+// Each pattern reads its squares as base-3 digits, 0 for empty, 1 for a cross and 2 for a knot,
+// and has its own weight for every index. Gaps never change during a game and read as empty.
+constexpr int NUM_PATTERNS = 20;
+constexpr int MAX_PATTERNS_PER_SQUARE = 5;
+
+constexpr std::array<std::uint64_t, NUM_PATTERNS> MASKS = {
+    // Rows
+    0x7Full << 0, 0x7Full << 7, 0x7Full << 14, 0x7Full << 21, 0x7Full << 28, 0x7Full << 35,
+    0x7Full << 42,
+    // Columns
+    0x0040810204081ull << 0, 0x0040810204081ull << 1, 0x0040810204081ull << 2,
+    0x0040810204081ull << 3, 0x0040810204081ull << 4, 0x0040810204081ull << 5,
+    0x0040810204081ull << 6,
+    // Diagonals a1-g7 and g1-a7
+    0x1010101010101ull, 0x0041041041040ull,
+    // Corners a1, g1, a7 and g7
+    0x1c387ull << 0, 0x1c387ull << 4, 0x1c387ull << 28, 0x1c387ull << 32};
+
+constexpr int pattern_size(int pattern) {
+    return __builtin_popcountll(MASKS[pattern]);
+}
+
+constexpr int pow3(int exponent) {
+    int result = 1;
+    for (int i = 0; i < exponent; ++i) {
+        result *= 3;
+    }
+    return result;
+}
+
+constexpr std::array<int, NUM_PATTERNS + 1> make_offsets() {
+    std::array<int, NUM_PATTERNS + 1> offsets{};
+    for (int pattern = 0; pattern < NUM_PATTERNS; ++pattern) {
+        offsets[pattern + 1] = offsets[pattern] + pow3(pattern_size(pattern));
+    }
+    return offsets;
+}
+
+// Start of each pattern's weights in the weight table
+constexpr std::array<int, NUM_PATTERNS + 1> OFFSETS = make_offsets();
+constexpr int NUM_WEIGHTS = OFFSETS[NUM_PATTERNS];
+
+// The base-3 value of the digits set in a pattern-sized bit string, pext order puts the lowest
+// square in the lowest digit
+constexpr std::array<std::uint16_t, 512> make_ternary() {
+    std::array<std::uint16_t, 512> ternary{};
+    for (int bits = 0; bits < 512; ++bits) {
+        int value = 0;
+        for (int i = 8; i >= 0; --i) {
+            value = 3 * value + ((bits >> i) & 1);
+        }
+        ternary[bits] = std::uint16_t(value);
+    }
+    return ternary;
+}
+
+constexpr std::array<std::uint16_t, 512> TERNARY = make_ternary();
+
+struct SquarePattern {
+    std::uint8_t pattern;
+    std::uint16_t power;
+};
+
+struct SquarePatterns {
+    int size;
+    SquarePattern entries[MAX_PATTERNS_PER_SQUARE];
+};
+
+// The patterns covering each square and the place value of the square within them, so a move
+// updates only the indices it touches
+constexpr std::array<SquarePatterns, 49> make_square_patterns() {
+    std::array<SquarePatterns, 49> square_patterns{};
+    for (int pattern = 0; pattern < NUM_PATTERNS; ++pattern) {
+        int digit = 0;
+        for (int sq = 0; sq < 49; ++sq) {
+            if (MASKS[pattern] & (std::uint64_t(1) << sq)) {
+                SquarePatterns& entry = square_patterns[sq];
+                entry.entries[entry.size++] = {std::uint8_t(pattern),
+                                               std::uint16_t(pow3(digit++))};
+            }
+        }
+    }
+    return square_patterns;
+}
+
+constexpr std::array<SquarePatterns, 49> SQUARE_PATTERNS = make_square_patterns();
+
+struct Indices {
+    std::uint16_t values[NUM_PATTERNS];
+};
+
+// Weights in eval units for crosses, knots score the negation
+extern std::int16_t weights[NUM_WEIGHTS];
+
+extern bool load(const std::string& path);
+extern bool write(const std::string& path);
+extern void unload();
+[[nodiscard]] extern bool loaded() noexcept;
+
+// Gathers the bits of value under mask into the low bits, one mask bit at a time
+inline std::uint64_t pext_portable(std::uint64_t value, std::uint64_t mask) {
+    std::uint64_t result = 0;
+    for (std::uint64_t bit = 1; mask; bit <<= 1) {
+        if (value & mask & -mask) {
+            result |= bit;
+        }
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+inline std::uint64_t pext(std::uint64_t value, std::uint64_t mask) {
+#if defined(__BMI2__)
+    return _pext_u64(value, mask);
+#else
+    return pext_portable(value, mask);
+#endif
+}
+
+inline void refresh(Bitboard crosses, Bitboard knots, Indices* indices) {
+    for (int pattern = 0; pattern < NUM_PATTERNS; ++pattern) {
+        indices->values[pattern] = std::uint16_t(TERNARY[pext(crosses, MASKS[pattern])] +
+                                                 2 * TERNARY[pext(knots, MASKS[pattern])]);
+    }
+}
+
+// Computes every index from scratch, done once at the root of each search
+inline void refresh(const Position& pos, Indices* indices) {
+    refresh(pos.pieces(constants::CROSS), pos.pieces(constants::KNOT), indices);
+}
+
+// Score for the side to move, in eval units
+[[nodiscard]] inline int evaluate(const Indices& indices, Piece side_to_move) {
+    int score = 0;
+    for (int pattern = 0; pattern < NUM_PATTERNS; ++pattern) {
+        score += weights[OFFSETS[pattern] + indices.values[pattern]];
+    }
+    return side_to_move == constants::CROSS ? score : -score;
+}
+
+inline void add_digit(Indices* indices, Square sq, int digit) {
+    const SquarePatterns& square_patterns = SQUARE_PATTERNS[sq];
+    for (int i = 0; i < square_patterns.size; ++i) {
+        const SquarePattern& entry = square_patterns.entries[i];
+        indices->values[entry.pattern] += entry.power * digit;
+    }
+}
+
+// Applies a move to the parent's indices, see nnue::update. Must be called with the position
+// before the move is made.
+template <Piece::Value::ColorValue Us>
+void update(const Position& pos, Move move, const Indices& parent, Indices* child) {
+    constexpr Piece::Value::ColorValue Them = Us == constants::CROSS ? Piece::Value::KNOT
+                                                                     : Piece::Value::CROSS;
+    constexpr int us_digit = Us == constants::CROSS ? 1 : 2;
+    *child = parent;
+    if (move == constants::MOVE_NULL) {
+        return;
+    }
+
+    Square from = move.from_square();
+    Square to = move.to_square();
+    add_digit(child, to, us_digit);
+    if (from != to) {
+        add_digit(child, from, -us_digit);
+    }
+    // Captured pieces turn from the other digit into ours
+    Bitboard captured = Bitboard{to}.adjacent() & pos.pieces(Piece{Them});
+    for (Square sq : Bitboard::Iterator{captured}) {
+        add_digit(child, sq, 2 * us_digit - 3);
+    }
+}
+
+}  // namespace loltaxx::patterns
+
+#endif  // LOLTAXX_PATTERNS_H
@@ -14,15 +14,15 @@ using loltaxx::Position;
 using loltaxx::Square;
 
 int count_moves(Position pos) {
-    Bitboard us = pos.piece_bb_[pos.side_to_move_];
-    Bitboard them = pos.piece_bb_[!pos.side_to_move_];
+    Bitboard us = pos.pieces(pos.side_to_move());
+    Bitboard them = pos.pieces(!pos.side_to_move());
 
     if (!us || !them) {
         return 0;
     }
 
     Bitboard occupancy = us | them;
-    Bitboard empty = ~(occupancy | pos.gaps_);
+    Bitboard empty = ~(occupancy | pos.gaps());
 
     Bitboard put_piece_bb = us.adjacent() & empty;
     int num_moves = put_piece_bb.popcount();
@@ -46,8 +46,8 @@ std::uint64_t perft(Position pos, int depth) {
         return count_moves(pos);
     }
 
-    loltaxx::PerftTTEntry entry = loltaxx::perft_tt.probe(pos.hash_);
-    if (entry.get_depth() == depth && entry.get_key() == pos.hash_) {
+    loltaxx::PerftTTEntry entry = loltaxx::perft_tt.probe(pos.hash());
+    if (entry.get_depth() == depth && entry.get_key() == pos.hash()) {
         ++tt_hits;
         return entry.get_nodes();
     }
@@ -61,7 +61,7 @@ std::uint64_t perft(Position pos, int depth) {
         count += perft(child_pos, depth - 1);
     }
 
-    loltaxx::perft_tt.write(depth, count, pos.hash_);
+    loltaxx::perft_tt.write(depth, count, pos.hash());
 
     return count;
 }
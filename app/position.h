@@ -18,6 +18,8 @@ static std::string STARTPOS_FEN = "x5o/7/7/7/7/7/o5x x 0";
 
 }  // namespace constants
 
+struct PackedPosition;
+
 class Position {
    private:
     Position() : side_to_move_(constants::CROSS), halfmoves_(0) {
@@ -68,12 +70,24 @@ class Position {
 
         hash_ = calculate_hash();
     }
+    Position(Bitboard crosses, Bitboard knots, Bitboard gaps, Piece side_to_move, int halfmoves = 0)
+        : side_to_move_(side_to_move), halfmoves_(halfmoves) {
+        piece_bb_[constants::CROSS] = crosses;
+        piece_bb_[constants::KNOT] = knots;
+        gaps_ = gaps;
+        hash_ = calculate_hash();
+    }
+    // Unpacks a training record straight into the boards, defined in packed_position.h
+    [[nodiscard]] static Position from_packed(const PackedPosition& packed);
 
+    template <Piece::Value::ColorValue Us>
     [[nodiscard]] MoveList legal_moves() const {
+        constexpr Piece::Value::ColorValue Them = Us == constants::CROSS ? Piece::Value::KNOT
+                                                                         : Piece::Value::CROSS;
         MoveList move_list;
 
-        Bitboard us = piece_bb_[side_to_move_];
-        Bitboard occupancy = us | piece_bb_[!side_to_move_];
+        Bitboard us = piece_bb_[Us];
+        Bitboard occupancy = us | piece_bb_[Them];
         Bitboard empty = ~(occupancy | gaps_);
 
         Bitboard put_piece_bb = us.adjacent() & empty;
@@ -94,10 +108,20 @@ class Position {
 
         return move_list;
     }
+    [[nodiscard]] MoveList legal_moves() const {
+        if (side_to_move_ == constants::CROSS) {
+            return legal_moves<Piece::Value::CROSS>();
+        } else {
+            return legal_moves<Piece::Value::KNOT>();
+        }
+    }
 
+    template <Piece::Value::ColorValue Us>
     void make_move(Move move) {
+        constexpr Piece::Value::ColorValue Them = Us == constants::CROSS ? Piece::Value::KNOT
+                                                                         : Piece::Value::CROSS;
         if (move == constants::MOVE_NULL) {
-            side_to_move_ = !side_to_move_;
+            side_to_move_ = Piece{Them};
             hash_ ^= constants::SIDE_TO_MOVE_KEY;
             return;
         }
@@ -105,29 +129,57 @@ class Position {
         Square from = move.from_square();
         Square to = move.to_square();
 
-        Bitboard captured = Bitboard{to}.adjacent() & piece_bb_[!side_to_move_];
-        piece_bb_[!side_to_move_] ^= captured;
-        piece_bb_[side_to_move_] ^= (Bitboard{from}) | (Bitboard{to}) | captured;
+        Bitboard captured = Bitboard{to}.adjacent() & piece_bb_[Them];
+        piece_bb_[Them] ^= captured;
+        piece_bb_[Us] ^= (Bitboard{from}) | (Bitboard{to}) | captured;
 
         ++halfmoves_;
 
         if (from == to) {
             halfmoves_ = 0;
-            hash_ ^= constants::PIECE_SQUARE_KEYS[side_to_move_][to];
+            hash_ ^= constants::PIECE_SQUARE_KEYS[Us][to];
         } else {
-            hash_ ^= constants::PIECE_SQUARE_KEYS[side_to_move_][from] ^
-                     constants::PIECE_SQUARE_KEYS[side_to_move_][to];
+            hash_ ^= constants::PIECE_SQUARE_KEYS[Us][from] ^ constants::PIECE_SQUARE_KEYS[Us][to];
         }
         if (captured) {
             for (Square sq : Bitboard::Iterator{captured}) {
-                hash_ ^= constants::PIECE_SQUARE_KEYS[!side_to_move_][sq] ^
-                         constants::PIECE_SQUARE_KEYS[side_to_move_][sq];
+                hash_ ^= constants::PIECE_SQUARE_KEYS[Them][sq] ^
+                         constants::PIECE_SQUARE_KEYS[Us][sq];
             }
         }
 
-        side_to_move_ = !side_to_move_;
+        side_to_move_ = Piece{Them};
         hash_ ^= constants::SIDE_TO_MOVE_KEY;
     }
+    void make_move(Move move) {
+        if (side_to_move_ == constants::CROSS) {
+            make_move<Piece::Value::CROSS>(move);
+        } else {
+            make_move<Piece::Value::KNOT>(move);
+        }
+    }
+
+    // The hash the position would have after the move, without making it
+    [[nodiscard]] std::uint64_t hash_after(Move move) const {
+        std::uint64_t key = hash_ ^ constants::SIDE_TO_MOVE_KEY;
+        if (move == constants::MOVE_NULL) {
+            return key;
+        }
+
+        Square from = move.from_square();
+        Square to = move.to_square();
+        if (from == to) {
+            key ^= constants::PIECE_SQUARE_KEYS[side_to_move_][to];
+        } else {
+            key ^= constants::PIECE_SQUARE_KEYS[side_to_move_][from] ^
+                   constants::PIECE_SQUARE_KEYS[side_to_move_][to];
+        }
+        Bitboard captured = Bitboard{to}.adjacent() & piece_bb_[!side_to_move_];
+        for (Square sq : Bitboard::Iterator{captured}) {
+            key ^= constants::PIECE_SQUARE_KEYS[0][sq] ^ constants::PIECE_SQUARE_KEYS[1][sq];
+        }
+        return key;
+    }
 
     std::uint64_t calculate_hash() {
         std::uint64_t key{0};
@@ -148,6 +200,9 @@ class Position {
     [[nodiscard]] Bitboard gaps() const {
         return gaps_;
     }
+    [[nodiscard]] Bitboard empty_squares() const {
+        return ~(piece_bb_[0] | piece_bb_[1] | gaps_) & Bitboard::full();
+    }
     [[nodiscard]] Piece side_to_move() const {
         return side_to_move_;
     }
@@ -157,6 +212,38 @@ class Position {
     [[nodiscard]] std::uint64_t hash() const {
         return hash_;
     }
+    // The FEN the constructor reads, with 'x' and 'o' for the pieces and '-' for gaps
+    [[nodiscard]] std::string fen() const {
+        std::string fen_str;
+        for (int rank = 6; rank >= 0; --rank) {
+            int empty = 0;
+            for (int file = 0; file < 7; ++file) {
+                Bitboard sq_bb{Square{rank * 7 + file}};
+                char c = piece_bb_[constants::CROSS] & sq_bb ? 'x'
+                         : piece_bb_[constants::KNOT] & sq_bb ? 'o'
+                         : gaps_ & sq_bb                      ? '-'
+                                                              : '\0';
+                if (!c) {
+                    ++empty;
+                    continue;
+                }
+                if (empty) {
+                    fen_str += char('0' + empty);
+                    empty = 0;
+                }
+                fen_str += c;
+            }
+            if (empty) {
+                fen_str += char('0' + empty);
+            }
+            if (rank) {
+                fen_str += '/';
+            }
+        }
+        fen_str += side_to_move_ == constants::CROSS ? " x " : " o ";
+        fen_str += std::to_string(halfmoves_);
+        return fen_str;
+    }
 
    private:
     Bitboard piece_bb_[2];
@@ -0,0 +1,86 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "CLI11/CLI11.hpp"
+
+#include "position_tracker.h"
+
+using loltaxx::Move;
+using loltaxx::MoveList;
+using loltaxx::Position;
+using loltaxx::PositionTracker;
+using loltaxx::UAIMoveList;
+using loltaxx::UAIPositionParameters;
+
+std::vector<std::string> random_game(int max_length, std::uint64_t seed) {
+    std::mt19937_64 rng{seed};
+    Position pos{loltaxx::constants::STARTPOS_FEN};
+    std::vector<std::string> moves;
+    int passes = 0;
+    while (int(moves.size()) < max_length && passes < 2) {
+        MoveList move_list = pos.legal_moves();
+        if (move_list.empty()) {
+            break;
+        }
+        Move move = move_list[int(rng() % move_list.size())];
+        passes = move == loltaxx::constants::MOVE_NULL ? passes + 1 : 0;
+        pos.make_move(move);
+        moves.push_back(move.to_str());
+    }
+    return moves;
+}
+
+// Average time in nanoseconds to process the command for `length` moves when the previous
+// command held `length - 1` moves, as a GUI sends it mid-game.
+double command_latency(const std::string& fen,
+                       const std::vector<std::string>& game,
+                       int length,
+                       int iterations,
+                       bool incremental) {
+    UAIPositionParameters previous{
+        fen, UAIMoveList{std::vector<std::string>(game.begin(), game.begin() + length - 1)}};
+    UAIPositionParameters current{
+        fen, UAIMoveList{std::vector<std::string>(game.begin(), game.begin() + length)}};
+
+    PositionTracker tracker;
+    std::chrono::nanoseconds elapsed{0};
+    for (int i = 0; i < iterations; ++i) {
+        if (incremental) {
+            tracker.update(previous);
+        } else {
+            tracker = PositionTracker{};
+        }
+        auto start = std::chrono::steady_clock::now();
+        tracker.update(current);
+        elapsed += std::chrono::steady_clock::now() - start;
+    }
+    return double(elapsed.count()) / iterations;
+}
+
+int main(int argc, char** argv) {
+    int max_length = 400;
+    int step = 50;
+    int iterations = 2000;
+    std::uint64_t seed = 1;
+
+    CLI::App app{"Measures position command latency against game length."};
+    app.add_option("-l,--length", max_length, "Longest game length to measure.", true);
+    app.add_option("-s,--step", step, "Game length step between measurements.", true);
+    app.add_option("-i,--iterations", iterations, "Commands to time per game length.", true);
+    app.add_option("--seed", seed, "Seed for the random game.", true);
+    CLI11_PARSE(app, argc, argv);
+
+    step = std::max(1, step);
+    iterations = std::max(1, iterations);
+
+    std::string fen{"x5o/7/7/7/7/7/o5x x 0 1"};
+    auto game = random_game(max_length, seed);
+    std::cout << "moves full_ns incremental_ns\n";
+    for (int length = step; length <= int(game.size()); length += step) {
+        double full = command_latency(fen, game, length, iterations, false);
+        double incremental = command_latency(fen, game, length, iterations, true);
+        std::cout << length << " " << full << " " << incremental << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#ifndef LOLTAXX_POSITION_TRACKER_H
+#define LOLTAXX_POSITION_TRACKER_H
+
+#include <string>
+#include <vector>
+
+#include "position.h"
+#include "uai_service.h"
+
+namespace loltaxx {
+
+class PositionTracker {
+   private:
+    constexpr static int RESERVED_MOVES = 1024;
+
+   public:
+    PositionTracker() : root_fen_(constants::STARTPOS_FEN), position_(constants::STARTPOS_FEN) {
+        moves_.reserve(RESERVED_MOVES);
+    }
+
+    // GUIs resend the whole game on every "position" command, so when the new command only
+    // extends the previous one we replay just the new moves on top of the current position.
+    void update(const UAIPositionParameters& position_parameters) {
+        const auto& move_list = position_parameters.move_list();
+        int num_moves = move_list ? int(move_list->move_list().size()) : 0;
+
+        int first_new_move = 0;
+        if (position_parameters.fen() == root_fen_ && num_moves >= int(moves_.size())) {
+            first_new_move = int(moves_.size());
+            for (int i = 0; i < first_new_move; ++i) {
+                auto move = Move::from((*move_list)[i]);
+                if (!move || *move != moves_[i]) {
+                    first_new_move = 0;
+                    break;
+                }
+            }
+        }
+
+        if (!first_new_move) {
+            root_fen_ = position_parameters.fen();
+            position_ = Position{root_fen_};
+            moves_.clear();
+        }
+
+        for (int i = first_new_move; i < num_moves; ++i) {
+            auto move = Move::from((*move_list)[i]);
+            if (!move) {
+                break;
+            }
+            position_.make_move(*move);
+            moves_.push_back(*move);
+        }
+    }
+
+    [[nodiscard]] const Position& position() const noexcept {
+        return position_;
+    }
+    [[nodiscard]] const std::vector<Move>& moves() const noexcept {
+        return moves_;
+    }
+
+   private:
+    std::string root_fen_;
+    std::vector<Move> moves_;
+    Position position_;
+};
+
+}  // namespace loltaxx
+
+#endif  // LOLTAXX_POSITION_TRACKER_H
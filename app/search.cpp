@@ -1,13 +1,70 @@
+#include <thread>
+
 #include "search.h"
 #include "eval.h"
+#include "tablebase.h"
 #include "tt.h"
 #include "uai_service.h"
 
 namespace loltaxx::search {
 
 TranspositionTable tt{128};
+Tablebase tablebase;
+
+enum class NodeType { Root, PV, NonPV };
+
+template <Piece::Value::ColorValue Us>
+constexpr Piece::Value::ColorValue opponent() {
+    return Us == constants::CROSS ? Piece::Value::KNOT : Piece::Value::CROSS;
+}
+
+// Uses the network when one is loaded, then the patterns on top of material, through the state
+// make_child keeps for this ply. The positional terms are opt-in: their finer scores cost more
+// nodes per depth than they gain.
+template <Piece::Value::ColorValue Us>
+int uncached_evaluate(Position* pos, SearchGlobals* sg, ThreadData* td, int ply) {
+    if (nnue::loaded()) {
+        return nnue::evaluate(td->accumulator(ply), Piece{Us});
+    }
+    if (patterns::loaded()) {
+        return material_eval(pos) + patterns::evaluate(td->pattern_indices(ply), Piece{Us});
+    }
+    return sg->positional_eval() ? eval(pos) : material_eval(pos);
+}
+
+// The same leaves come back through transpositions and across iterations
+template <Piece::Value::ColorValue Us>
+int evaluate(Position* pos, SearchGlobals* sg, ThreadData* td, int ply) {
+    if (!sg->eval_cache()) {
+        return uncached_evaluate<Us>(pos, sg, td, ply);
+    }
+    EvalCache& cache = td->eval_cache();
+    if (auto score = cache.probe(pos->hash())) {
+        return *score;
+    }
+    int score = uncached_evaluate<Us>(pos, sg, td, ply);
+    cache.store(pos->hash(), score);
+    return score;
+}
+
+template <Piece::Value::ColorValue Us>
+Position make_child(const Position& pos, Move move, ThreadData* td, int ply) {
+    if (nnue::loaded()) {
+        nnue::update<Us>(pos, move, td->accumulator(ply), &td->accumulator(ply + 1));
+    }
+    if (patterns::loaded()) {
+        patterns::update<Us>(pos, move, td->pattern_indices(ply), &td->pattern_indices(ply + 1));
+    }
+    Position child = pos;
+    child.make_move<Us>(move);
+    return child;
+}
 
-void sort_moves(Position pos, MoveList* move_list, std::optional<Move> tt_move = {}) {
+template <Piece::Value::ColorValue Us>
+void sort_moves(const Position& pos, MoveList* move_list, std::optional<Move> tt_move = {}) {
+    constexpr Piece::Value::ColorValue Them = opponent<Us>();
+    Bitboard us = pos.pieces(Piece{Us});
+    Bitboard them = pos.pieces(Piece{Them});
     move_list->sort([&](Move move) {
         if (tt_move && *tt_move == move) {
             return 1000000;
@@ -15,12 +72,11 @@ void sort_moves(Position pos, MoveList* move_list, std::optional<Move> tt_move =
             Square to = move.to_square();
             Bitboard from_bb{move.from_square()};
             Bitboard to_bb{to};
-            Piece stm = pos.side_to_move();
 
-            Bitboard captured = Bitboard{to}.adjacent() & pos.pieces(!stm);
+            Bitboard captured = Bitboard{to}.adjacent() & them;
 
-            int piece_diff = (pos.pieces(stm) ^ (from_bb | to_bb | captured)).popcount() -
-                             (pos.pieces(!stm) ^ captured).popcount();
+            int piece_diff = (us ^ (from_bb | to_bb | captured)).popcount() -
+                             (them ^ captured).popcount();
             if (piece_diff > 1) {
                 return 10000 + piece_diff;
             } else {
@@ -30,109 +86,286 @@ void sort_moves(Position pos, MoveList* move_list, std::optional<Move> tt_move =
     });
 }
 
-std::uint64_t cutoffs = 0;
-std::uint64_t first_cutoffs = 0;
+static const int ASPIRATION_MIN_DEPTH = 4;
+static const int ASPIRATION_WINDOW = 1000;
+static const int ETC_MIN_DEPTH = 4;
+static const int NULL_MOVE_MIN_DEPTH = 3;
+static const int REVERSE_FUTILITY_MAX_DEPTH = 3;
+static const int REVERSE_FUTILITY_MARGIN = 2500;
+static const int LMR_MIN_DEPTH = 4;
+static const int LMR_MIN_MOVE_NUM = 4;
+// Reductions and the null move reduction are kept even, an odd reduction would end lines with
+// the other side to move and material swings too much from move to move for that to compare
+static const int LMR_REDUCTION = 2;
+
+TranspositionTable& transposition_table(const SearchGlobals* sg) {
+    return sg->tt() ? *sg->tt() : tt;
+}
+
+void set_hash_size(int mb) {
+    tt.resize(mb);
+    tt.clear();
+}
+
+void clear_hash() {
+    tt.clear();
+}
+
+bool set_tablebase_path(const std::string& path) {
+    if (path.empty() || path == "<empty>") {
+        tablebase.unload();
+        return true;
+    }
+    return tablebase.load(path);
+}
+
+UAILine& operator<<(UAILine& line, Move move) {
+    char move_str[4];
+    return line << std::string_view{move_str, std::size_t(move.to_chars(move_str))};
+}
+
+void report_currmove(Move move, int move_num, int depth, SearchGlobals* sg) {
+    if (!(sg->verbose() && sg->start_time())) {
+        return;
+    }
+    auto now = curr_time();
+    if (!sg->info_due(now)) {
+        return;
+    }
+
+    std::uint64_t time_taken = (now - *sg->start_time()).count();
+    std::uint64_t nodes = sg->nodes();
+    std::uint64_t nps = time_taken ? nodes * 1000 / time_taken : nodes;
+    UAILine line;
+    line << "info depth " << depth << " currmove " << move << " currmovenumber " << move_num
+         << " time " << time_taken << " nodes " << nodes << " nps " << nps << " hashfull "
+         << transposition_table(sg).hashfull();
+    UAIService::info(line);
+}
 
-SearchResult search_impl(Position pos, int alpha, int beta, int depth, int ply, SearchGlobals* sg) {
-    sg->increment_nodes();
+// Node type and side to move are template parameters so the root, PV and zero-window paths each
+// compile without the branches that cannot apply to them, and move generation needs no colour
+// lookups
+template <NodeType NT, Piece::Value::ColorValue Us>
+int search_impl(Position pos,
+                int alpha,
+                int beta,
+                int depth,
+                int ply,
+                SearchGlobals* sg,
+                ThreadData* td) {
+    constexpr Piece::Value::ColorValue Them = opponent<Us>();
+    constexpr bool pv_node = NT != NodeType::NonPV;
+    constexpr NodeType ChildNT = pv_node ? NodeType::PV : NodeType::NonPV;
+    td->increment_nodes();
+
+    MoveList& pv = td->pv(ply);
+    pv.clear();
 
     if (depth <= 0) {
-        return SearchResult{eval(&pos), {}};
+        return evaluate<Us>(&pos, sg, td, ply);
     }
 
-    if (ply) {
-        if (sg->stop()) {
-            return {0, {}};
+    if constexpr (NT != NodeType::Root) {
+        if (sg->stop(td)) {
+            return 0;
         }
 
         if (pos.halfmoves() >= 100) {
-            return {0, {}};
+            return 0;
         }
 
         if (ply >= MAX_PLY) {
-            return {eval(&pos), {}};
+            return evaluate<Us>(&pos, sg, td, ply);
         }
 
         alpha = std::max((-MATE_SCORE + ply), alpha);
         beta = std::min((MATE_SCORE - ply), beta);
         if (alpha >= beta) {
-            return {alpha, {}};
+            return alpha;
+        }
+
+        // Tablebase results are scored like mates, at the distance to the end of the game
+        if (auto tb_entry = tablebase.probe(pos)) {
+            td->increment_tbhits();
+            switch (tb_entry->result) {
+                case Tablebase::WIN:
+                    return MATE_SCORE - ply - tb_entry->distance;
+                case Tablebase::LOSS:
+                    return -MATE_SCORE + ply + tb_entry->distance;
+                default:
+                    return 0;
+            }
         }
     }
 
-    bool pv_node = alpha != beta - 1;
+    // A PV node can still be handed a zero window, as the MTD(f) root always is, and then has no
+    // line worth searching with a wider one
+    bool full_window = pv_node && beta - alpha > 1;
+
+    // The bound stored at the end is judged against the window the node was given, not the alpha
+    // raised by its own moves
+    int original_alpha = alpha;
 
     auto hash = pos.hash();
-    TTEntry tt_entry = tt.probe(hash);
+    TranspositionTable& table = transposition_table(sg);
+    TTEntry tt_entry = table.probe(hash);
     Move tt_move;
     if (tt_entry.get_key() == hash) {
         tt_move = Move{tt_entry.get_move()};
-        int tt_score = tt_entry.get_score();
-        int tt_flag = tt_entry.get_flag();
-        if (tt_entry.get_depth() >= depth) {
-            if ((tt_flag == TTConstants::FLAG_LOWER && tt_score >= beta) ||
-                (tt_flag == TTConstants::FLAG_UPPER && tt_score < alpha) ||
-                (tt_flag == TTConstants::FLAG_EXACT)) {
-                MoveList mlist;
-                mlist.add(tt_move);
-                return {tt_score, mlist};
+        // The root always searches, so that a re-search with a new window or without some of
+        // its moves gets a score and a PV of its own
+        if constexpr (NT != NodeType::Root) {
+            int tt_score = tt_entry.get_score();
+            int tt_flag = tt_entry.get_flag();
+            if (tt_entry.get_depth() >= depth &&
+                ((tt_flag == TTConstants::FLAG_LOWER && tt_score >= beta) ||
+                 (tt_flag == TTConstants::FLAG_UPPER && tt_score <= alpha) ||
+                 (tt_flag == TTConstants::FLAG_EXACT))) {
+                pv.add(tt_move);
+                return tt_score;
             }
         }
     }
 
-    MoveList move_list = pos.legal_moves();
+    MoveList move_list = pos.legal_moves<Us>();
     if (move_list[0] == constants::MOVE_NULL) {
-        return SearchResult{eval(&pos), move_list};
+        pv.add(constants::MOVE_NULL);
+        return evaluate<Us>(&pos, sg, td, ply);
     }
 
     if (move_list.empty()) {
-        return SearchResult{-MATE_SCORE + ply, {}};
+        return -MATE_SCORE + ply;
+    }
+
+    if constexpr (NT == NodeType::Root) {
+        const MoveList& excluded = td->excluded_root_moves();
+        if (!excluded.empty()) {
+            MoveList remaining;
+            for (Move move : move_list) {
+                if (!excluded.contains(move)) {
+                    remaining.add(move);
+                }
+            }
+            move_list = remaining;
+        }
+    }
+
+    // Enhanced transposition cutoff: a child whose stored upper bound already refutes this node
+    // saves making the move and searching it
+    if (NT == NodeType::NonPV && depth >= ETC_MIN_DEPTH) {
+        for (Move move : move_list) {
+            std::uint64_t child_hash = pos.hash_after(move);
+            TTEntry child_entry = table.probe(child_hash);
+            if (child_entry.get_key() != child_hash || child_entry.get_depth() < depth - 1) {
+                continue;
+            }
+            int child_flag = child_entry.get_flag();
+            int score = -child_entry.get_score();
+            if ((child_flag == TTConstants::FLAG_UPPER || child_flag == TTConstants::FLAG_EXACT) &&
+                score >= beta) {
+                table.write(move.value(), TTConstants::FLAG_LOWER, depth, score, hash);
+                return score;
+            }
+        }
+    }
+
+    if constexpr (NT == NodeType::NonPV) {
+        bool try_reverse_futility = sg->reverse_futility_pruning() &&
+                                    depth <= REVERSE_FUTILITY_MAX_DEPTH &&
+                                    std::abs(beta) < MAX_MATE_SCORE;
+        // Passing stands in for the null move, it is only legal in Ataxx when forced
+        bool try_null_move = sg->null_move_pruning() && depth >= NULL_MOVE_MIN_DEPTH &&
+                             td->current_move(ply - 1) != constants::MOVE_NULL;
+
+        // The static eval is only wanted by the pruning rules that apply here
+        if (try_reverse_futility || try_null_move) {
+            int static_eval = evaluate<Us>(&pos, sg, td, ply);
+
+            if (try_reverse_futility && static_eval - REVERSE_FUTILITY_MARGIN * depth >= beta) {
+                return static_eval;
+            }
+
+            if (try_null_move && static_eval >= beta) {
+                int reduction = 2 + 2 * (depth >= 8);
+                Position child = make_child<Us>(pos, constants::MOVE_NULL, td, ply);
+                td->set_current_move(ply, constants::MOVE_NULL);
+                int score = -search_impl<NodeType::NonPV, Them>(
+                    child, -beta, -beta + 1, depth - 1 - reduction, ply + 1, sg, td);
+                if (sg->stop(td)) {
+                    return 0;
+                }
+                if (score >= beta) {
+                    return score >= MAX_MATE_SCORE ? beta : score;
+                }
+            }
+        }
     }
 
-    sort_moves(pos, &move_list, tt_move);
+    sort_moves<Us>(pos, &move_list, tt_move);
 
-    MoveList pv;
+    Move best_move = move_list[0];
     int best_score = -INFINITE;
     int move_num = 0;
     for (Move move : move_list) {
-        Position child = pos;
-        child.make_move(move);
+        Position child = make_child<Us>(pos, move, td, ply);
+        td->set_current_move(ply, move);
         ++move_num;
 
+        if (NT == NodeType::Root && td->main_thread()) {
+            report_currmove(move, move_num, depth, sg);
+        }
+
         int depth_left = depth - 1;
 
-        SearchResult result{0, {}};
-        if (move_num == 1) {
-        pv_search:
-            result = -search_impl(child, -beta, -alpha, depth_left, ply + 1, sg);
+        // Late jumps and non-capturing moves are searched shallower unless history likes them
+        int reduction = 0;
+        if (sg->late_move_reductions() && depth >= LMR_MIN_DEPTH &&
+            move_num >= LMR_MIN_MOVE_NUM && move != tt_move) {
+            Bitboard captured = Bitboard{move.to_square()}.adjacent() & pos.pieces(Piece{Them});
+            bool jump = move.from_square() != move.to_square();
+            if ((jump || !captured) && td->history(Piece{Us}, move) <= HISTORY_MAX / 4) {
+                reduction = LMR_REDUCTION;
+            }
+        }
+
+        int score;
+        if (move_num == 1 && full_window) {
+            score = -search_impl<ChildNT, Them>(child, -beta, -alpha, depth_left, ply + 1, sg, td);
         } else {
-            result = -search_impl(child, -alpha - 1, -alpha, depth_left, ply + 1, sg);
-            if (result.score > alpha) {
-                goto pv_search;
+            score = -search_impl<NodeType::NonPV, Them>(
+                child, -alpha - 1, -alpha, depth_left - reduction, ply + 1, sg, td);
+            if (score > alpha && reduction) {
+                score = -search_impl<NodeType::NonPV, Them>(
+                    child, -alpha - 1, -alpha, depth_left, ply + 1, sg, td);
+            }
+            if (full_window && score > alpha) {
+                score = -search_impl<NodeType::PV, Them>(
+                    child, -beta, -alpha, depth_left, ply + 1, sg, td);
             }
         }
 
-        if (ply && sg->stop()) {
-            return SearchResult{0, {}};
+        if (sg->stop(td)) {
+            return 0;
         }
 
-        if (result.score > best_score) {
-            best_score = result.score;
+        if (score > best_score) {
+            best_score = score;
+            best_move = move;
             if (best_score > alpha) {
                 alpha = best_score;
 
-                if (pv_node) {
+                if constexpr (pv_node) {
                     pv.clear();
                     pv.add(move);
-                    if (result.pv) {
-                        pv.add(*result.pv);
-                    }
+                    pv.add(td->pv(ply + 1));
                 }
 
                 if (alpha >= beta) {
-                    ++cutoffs;
-                    if (move_num == 1) {
-                        ++first_cutoffs;
+                    int bonus = depth * depth;
+                    td->update_history(Piece{Us}, move, bonus);
+                    for (int i = 0; i < move_num - 1; ++i) {
+                        td->update_history(Piece{Us}, move_list[i], -bonus);
                     }
                     break;
                 }
@@ -140,27 +373,188 @@ SearchResult search_impl(Position pos, int alpha, int beta, int depth, int ply,
         }
     }
 
-    int tt_flag = best_score >= beta ? TTConstants::FLAG_LOWER
-                                     : best_score < alpha ? TTConstants::FLAG_UPPER : FLAG_EXACT;
-    tt.write(pv[0].value(), tt_flag, depth, best_score, hash);
+    int tt_flag = best_score >= beta             ? TTConstants::FLAG_LOWER
+                  : best_score <= original_alpha ? TTConstants::FLAG_UPPER
+                                                 : TTConstants::FLAG_EXACT;
+    // A root searched without some of its moves has no score of its own to store
+    if (NT != NodeType::Root || td->excluded_root_moves().empty()) {
+        table.write(best_move.value(), tt_flag, depth, best_score, hash);
+    }
+
+    return best_score;
+}
 
-    return {best_score, pv};
+int search_root(Position pos,
+                int alpha,
+                int beta,
+                int depth,
+                SearchGlobals* sg,
+                ThreadData* td) {
+    if (nnue::loaded()) {
+        nnue::refresh(pos, &td->accumulator(0));
+    }
+    if (patterns::loaded()) {
+        patterns::refresh(pos, &td->pattern_indices(0));
+    }
+    if (pos.side_to_move() == constants::CROSS) {
+        return search_impl<NodeType::Root, Piece::Value::CROSS>(
+            pos, alpha, beta, depth, 0, sg, td);
+    } else {
+        return search_impl<NodeType::Root, Piece::Value::KNOT>(
+            pos, alpha, beta, depth, 0, sg, td);
+    }
 }
 
 SearchResult search(Position pos, int depth) {
     tt.clear();
     SearchGlobals search_globals = SearchGlobals::new_search_globals();
+    ThreadData* td = search_globals.thread(0);
+    int score = search_root(pos, -INFINITE, +INFINITE, depth, &search_globals, td);
+    return SearchResult{score, td->pv(0)};
+}
+
+int search(Position pos, SearchGlobals* search_globals, ThreadData* td, int depth) {
     int alpha = -INFINITE;
     int beta = +INFINITE;
-    SearchResult search_result = search_impl(pos, alpha, beta, depth, 0, &search_globals);
-    return search_result;
+    return search_root(pos, alpha, beta, depth, search_globals, td);
 }
 
-SearchResult search(Position pos, SearchGlobals* search_globals, int depth) {
+void report_pv(SearchGlobals* sg,
+               const MoveList& pv,
+               int line_num,
+               int depth,
+               int score,
+               int bound) {
+    std::uint64_t time_taken = (curr_time() - *sg->start_time()).count();
+    std::uint64_t nodes = sg->nodes();
+    std::uint64_t nps = time_taken ? nodes * 1000 / time_taken : nodes;
+
+    UAILine line;
+    line << "info";
+    if (sg->multipv() > 1) {
+        line << " multipv " << line_num;
+    }
+    line << " score cp " << score;
+    if (bound == TTConstants::FLAG_LOWER) {
+        line << " lowerbound";
+    } else if (bound == TTConstants::FLAG_UPPER) {
+        line << " upperbound";
+    }
+    line << " depth " << depth << " time " << time_taken << " nodes " << nodes << " nps " << nps;
+    if (tablebase.loaded()) {
+        line << " tbhits " << sg->tbhits();
+    }
+    if (!pv.empty()) {
+        line << " pv";
+        for (int i = 0; i < pv.size(); ++i) {
+            line << ' ' << pv[i];
+        }
+    }
+    UAIService::info(line);
+}
+
+// Searches the root inside a window around the score from two iterations back, which has the
+// same side making the last move, widening it exponentially on each fail-low or fail-high
+int aspiration_search(Position pos,
+                      SearchGlobals* sg,
+                      ThreadData* td,
+                      int line_num,
+                      int depth,
+                      int guess) {
+    int delta = ASPIRATION_WINDOW;
     int alpha = -INFINITE;
     int beta = +INFINITE;
-    SearchResult search_result = search_impl(pos, alpha, beta, depth, 1, search_globals);
-    return search_result;
+    if (depth >= ASPIRATION_MIN_DEPTH && std::abs(guess) < MAX_MATE_SCORE) {
+        alpha = std::max(guess - delta, -INFINITE);
+        beta = std::min(guess + delta, +INFINITE);
+    }
+
+    while (true) {
+        int score = search_root(pos, alpha, beta, depth, sg, td);
+        if (sg->stop(td)) {
+            return score;
+        }
+
+        if (score <= alpha) {
+            if (sg->verbose()) {
+                report_pv(sg, td->pv(0), line_num, depth, score, TTConstants::FLAG_UPPER);
+            }
+            beta = (alpha + beta) / 2;
+            alpha = std::max(score - delta, -INFINITE);
+        } else if (score >= beta) {
+            if (sg->verbose()) {
+                report_pv(sg, td->pv(0), line_num, depth, score, TTConstants::FLAG_LOWER);
+            }
+            beta = std::min(score + delta, +INFINITE);
+        } else {
+            return score;
+        }
+        delta *= 2;
+    }
+}
+
+// Follows the TT from the root move to fill in the rest of the PV, which zero-window searches
+// leave empty below the root
+void extract_pv(Position pos, SearchGlobals* sg, ThreadData* td, Move root_move, int depth) {
+    MoveList& pv = td->pv(0);
+    pv.clear();
+    pv.add(root_move);
+    pos.make_move(root_move);
+    for (int ply = 1; ply < depth; ++ply) {
+        TTEntry tt_entry = transposition_table(sg).probe(pos.hash());
+        if (tt_entry.get_key() != pos.hash()) {
+            break;
+        }
+        Move move{tt_entry.get_move()};
+        if (!pos.legal_moves().contains(move)) {
+            break;
+        }
+        pv.add(move);
+        pos.make_move(move);
+    }
+}
+
+// MTD(f): zero-window searches at the current bounds move the test value towards the score from
+// two iterations back until the bounds meet. Evaluation moves in whole pieces, so few passes are
+// usually needed once the guess is close.
+int mtdf_search(Position pos, SearchGlobals* sg, ThreadData* td, int depth, int guess) {
+    int lower = -INFINITE;
+    int upper = +INFINITE;
+    int score = std::clamp(guess, -MATE_SCORE, MATE_SCORE);
+    std::optional<Move> best_move;
+    while (lower < upper) {
+        int beta = std::max(score, lower + 1);
+        score = search_root(pos, beta - 1, beta, depth, sg, td);
+        if (sg->stop(td)) {
+            return score;
+        }
+
+        if (score < beta) {
+            upper = score;
+        } else {
+            lower = score;
+            // Only a fail-high proves the root move, a fail-low leaves an arbitrary one
+            if (!td->pv(0).empty()) {
+                best_move = td->pv(0)[0];
+            }
+        }
+    }
+
+    if (best_move) {
+        extract_pv(pos, sg, td, *best_move, depth);
+    }
+    return score;
+}
+
+// Lazy SMP: helpers run their own iterative deepening over the shared TT, half of them one ply
+// ahead, and only feed the main thread through the table
+void helper_search(Position pos, SearchGlobals* search_globals, ThreadData* td) {
+    for (int depth = 1 + td->id() % 2; depth <= MAX_PLY; ++depth) {
+        search(pos, search_globals, td, depth);
+        if (search_globals->stop(td)) {
+            break;
+        }
+    }
 }
 
 std::optional<loltaxx::Move> best_move_search(loltaxx::Position pos,
@@ -170,43 +564,95 @@ std::optional<loltaxx::Move> best_move_search(loltaxx::Position pos,
     search_globals->set_stop_flag(false);
     search_globals->set_side_to_move(pos.side_to_move());
     search_globals->reset_nodes();
+    search_globals->reset_tbhits();
     search_globals->set_start_time(start_time);
-    for (int depth = 1; depth <= MAX_PLY; ++depth) {
-        auto search_result = search(pos, search_globals, depth);
+    search_globals->set_pv(MoveList{});
 
-        if (depth > 1 && search_globals->stop()) {
-            return best_move;
-        }
+    for (int id = 0; id < search_globals->num_threads(); ++id) {
+        search_globals->thread(id)->clear_history();
+        // The eval source may have changed since the last search
+        search_globals->thread(id)->eval_cache().clear();
+    }
+
+    std::vector<std::thread> helpers;
+    for (int id = 1; id < search_globals->num_threads(); ++id) {
+        helpers.emplace_back(helper_search, pos, search_globals, search_globals->thread(id));
+    }
+
+    ThreadData* td = search_globals->thread(0);
+    int max_depth = MAX_PLY;
+    if (search_globals->go_parameters() && search_globals->go_parameters()->depth()) {
+        max_depth = std::clamp(*search_globals->go_parameters()->depth(), 1, MAX_PLY);
+    }
+    // MultiPV searches the root once per line, each time without the root moves of the lines
+    // before it. Every line keeps its own aspiration window around its score from two iterations
+    // back, and the later lines mostly reuse the TT entries left by the earlier ones.
+    int num_lines = std::min(search_globals->multipv(), std::max(pos.legal_moves().size(), 1));
+    int scores[MAX_PLY + 1][MAX_MULTIPV]{};
+    MoveList line_pvs[MAX_MULTIPV];
+    MoveList& excluded = td->excluded_root_moves();
+    for (int depth = 1; depth <= max_depth; ++depth) {
+        excluded.clear();
+        int lines_found = 0;
+        for (; lines_found < num_lines; ++lines_found) {
+            int guess = scores[std::max(depth - 2, 0)][lines_found];
+            int score = search_globals->driver() == SearchDriver::MTDF
+                            ? mtdf_search(pos, search_globals, td, depth, guess)
+                            : aspiration_search(
+                                  pos, search_globals, td, lines_found + 1, depth, guess);
+
+            if (depth > 1 && search_globals->stop(td)) {
+                break;
+            }
+
+            const MoveList& pv = td->pv(0);
+            if (pv.empty()) {
+                break;
+            }
 
-        auto time_diff = curr_time() - start_time;
+            scores[depth][lines_found] = score;
+            line_pvs[lines_found] = pv;
+            excluded.add(pv[0]);
+        }
+        excluded.clear();
 
-        int score = search_result.score;
-        auto& pv = search_result.pv;
-        if (!pv) {
+        // An unfinished iteration is dropped, as the single line search always did
+        if (lines_found < num_lines) {
             break;
         }
 
-        best_move = *pv->begin();
+        // Search instability can leave a later line above an earlier one
+        for (int i = 1; i < num_lines; ++i) {
+            for (int j = i; j > 0 && scores[depth][j] > scores[depth][j - 1]; --j) {
+                std::swap(scores[depth][j], scores[depth][j - 1]);
+                std::swap(line_pvs[j], line_pvs[j - 1]);
+            }
+        }
 
-        std::uint64_t time_taken = time_diff.count();
-        std::uint64_t nodes = search_globals->nodes();
-        std::uint64_t nps = time_taken ? nodes * 1000 / time_taken : nodes;
-        UAIInfoParameters info_parameters{{
-            {"depth", depth},
-            {"score", score},
-            {"time", int(time_taken)},
-            {"nps", nps},
-            {"nodes", nodes},
-        }};
-        // std::cout << "fbf rate: " << first_cutoffs * 100llu / double(cutoffs) << "\n";
+        best_move = line_pvs[0][0];
+        search_globals->set_score(scores[depth][0]);
+        search_globals->set_pv(line_pvs[0]);
 
-        std::vector<std::string> str_move_list;
-        str_move_list.reserve(pv->size());
-        for (auto move : *pv) {
-            str_move_list.push_back(move.to_str());
+        if (search_globals->verbose()) {
+            for (int i = 0; i < num_lines; ++i) {
+                report_pv(search_globals, line_pvs[i], i + 1, depth, scores[depth][i],
+                          TTConstants::FLAG_EXACT);
+            }
         }
-        info_parameters.set_pv(UAIMoveList{str_move_list});
-        UAIService::info(info_parameters);
+    }
+
+    search_globals->set_stop_flag(true);
+    for (auto& helper : helpers) {
+        helper.join();
+    }
+
+    if (search_globals->verbose()) {
+        std::uint64_t probes = search_globals->eval_cache_probes();
+        UAILine line;
+        line << "info string evalcache hits " << search_globals->eval_cache_hits() << " probes "
+             << probes << " hitrate "
+             << (probes ? search_globals->eval_cache_hits() * 100 / probes : 0) << '%';
+        UAIService::info(line);
     }
 
     return best_move;
@@ -1,24 +1,40 @@
 #ifndef LOLTAXX_SEARCH_H
 #define LOLTAXX_SEARCH_H
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "eval_cache.h"
+#include "nnue.h"
+#include "patterns.h"
 #include "position.h"
 #include "uai_service.h"
 
+struct TranspositionTable;
+
 namespace loltaxx::search {
 
 static const int MAX_PLY = 128;
 static const int INFINITE = 300001;
 static const int MATE_SCORE = 300000;
 static const int MAX_MATE_SCORE = MATE_SCORE - MAX_PLY;
+static const int HISTORY_MAX = 16384;
+static const int MAX_MULTIPV = 64;
 
 static inline std::chrono::milliseconds curr_time() {
     return std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::high_resolution_clock::now().time_since_epoch());
 }
 
+// Root driver for iterative deepening: aspirated principal variation search, or MTD(f), which
+// converges on the score with zero-window searches only
+enum class SearchDriver { PVS, MTDF };
+
 struct SearchResult {
     SearchResult(int score_, std::optional<loltaxx::MoveList> pv_) noexcept
         : score(score_), pv(std::move(pv_)) {
@@ -32,30 +48,216 @@ struct SearchResult {
     std::optional<loltaxx::MoveList> pv;
 };
 
+class ThreadData {
+   public:
+    explicit ThreadData(int id) noexcept : id_(id), nodes_(0), tbhits_(0) {
+    }
+
+    [[nodiscard]] int id() const noexcept {
+        return id_;
+    }
+    [[nodiscard]] bool main_thread() const noexcept {
+        return id_ == 0;
+    }
+    [[nodiscard]] std::uint64_t nodes() const noexcept {
+        return nodes_.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] std::uint64_t tbhits() const noexcept {
+        return tbhits_.load(std::memory_order_relaxed);
+    }
+    // Triangular PV table, the line from ply onwards is kept in pv(ply)
+    [[nodiscard]] MoveList& pv(int ply) noexcept {
+        return pv_[ply];
+    }
+    // Network accumulators along the current line, the one for ply is updated from ply - 1, so
+    // returning to a ply needs no undo
+    [[nodiscard]] nnue::Accumulator& accumulator(int ply) noexcept {
+        return accumulators_[ply];
+    }
+    // Pattern indices along the current line, kept the same way as the accumulators
+    [[nodiscard]] patterns::Indices& pattern_indices(int ply) noexcept {
+        return pattern_indices_[ply];
+    }
+    [[nodiscard]] EvalCache& eval_cache() noexcept {
+        return eval_cache_;
+    }
+    [[nodiscard]] const EvalCache& eval_cache() const noexcept {
+        return eval_cache_;
+    }
+    // Root moves of the MultiPV lines already found this iteration, the root search skips them
+    [[nodiscard]] MoveList& excluded_root_moves() noexcept {
+        return excluded_root_moves_;
+    }
+    [[nodiscard]] Move current_move(int ply) const noexcept {
+        return current_moves_[ply];
+    }
+    [[nodiscard]] int history(Piece side, Move move) const noexcept {
+        return history_[side][move.from_square()][move.to_square()];
+    }
+
+    void set_current_move(int ply, Move move) noexcept {
+        current_moves_[ply] = move;
+    }
+    // Gravity keeps scores within [-HISTORY_MAX, HISTORY_MAX] without periodic aging
+    void update_history(Piece side, Move move, int bonus) noexcept {
+        int& entry = history_[side][move.from_square()][move.to_square()];
+        entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+    }
+    void clear_history() noexcept {
+        std::fill(&history_[0][0][0], &history_[0][0][0] + 2 * 49 * 49, 0);
+    }
+
+    void reset_nodes() noexcept {
+        nodes_.store(0, std::memory_order_relaxed);
+    }
+    // Only the owning thread writes its counter, so a plain store avoids a locked increment
+    void increment_nodes() noexcept {
+        nodes_.store(nodes() + 1, std::memory_order_relaxed);
+    }
+    void reset_tbhits() noexcept {
+        tbhits_.store(0, std::memory_order_relaxed);
+    }
+    void increment_tbhits() noexcept {
+        tbhits_.store(tbhits() + 1, std::memory_order_relaxed);
+    }
+
+   private:
+    int id_;
+    std::atomic<std::uint64_t> nodes_;
+    std::atomic<std::uint64_t> tbhits_;
+    MoveList pv_[MAX_PLY + 1];
+    MoveList excluded_root_moves_;
+    nnue::Accumulator accumulators_[MAX_PLY + 1];
+    patterns::Indices pattern_indices_[MAX_PLY + 1];
+    EvalCache eval_cache_;
+    Move current_moves_[MAX_PLY + 1];
+    int history_[2][49][49]{};
+};
+
 class SearchGlobals {
    public:
-    SearchGlobals(uint64_t nodes,
-                  std::optional<std::chrono::milliseconds> start_time,
+    SearchGlobals(std::optional<std::chrono::milliseconds> start_time,
                   std::optional<loltaxx::UAIGoParameters> go_parameters) noexcept
         : side_to_move_(loltaxx::constants::CROSS),
           stop_flag_(false),
-          nodes_(nodes),
           start_time_(start_time),
-          go_parameters_(std::move(go_parameters)) {
+          go_parameters_(std::move(go_parameters)),
+          info_interval_(1000),
+          last_info_time_(0),
+          driver_(SearchDriver::PVS),
+          tt_(nullptr),
+          multipv_(1),
+          score_(0),
+          verbose_(true),
+          null_move_pruning_(true),
+          late_move_reductions_(true),
+          reverse_futility_pruning_(true),
+          eval_cache_(true),
+          positional_eval_(false) {
+        set_num_threads(1);
     }
 
     [[nodiscard]] std::uint64_t nodes() const noexcept {
-        return nodes_;
+        std::uint64_t nodes = 0;
+        for (const auto& thread : threads_) {
+            nodes += thread->nodes();
+        }
+        return nodes;
+    }
+    [[nodiscard]] std::uint64_t tbhits() const noexcept {
+        std::uint64_t tbhits = 0;
+        for (const auto& thread : threads_) {
+            tbhits += thread->tbhits();
+        }
+        return tbhits;
+    }
+    [[nodiscard]] std::uint64_t eval_cache_hits() const noexcept {
+        std::uint64_t hits = 0;
+        for (const auto& thread : threads_) {
+            hits += thread->eval_cache().hits();
+        }
+        return hits;
+    }
+    [[nodiscard]] std::uint64_t eval_cache_probes() const noexcept {
+        std::uint64_t probes = 0;
+        for (const auto& thread : threads_) {
+            probes += thread->eval_cache().probes();
+        }
+        return probes;
+    }
+    [[nodiscard]] int num_threads() const noexcept {
+        return int(threads_.size());
+    }
+    [[nodiscard]] ThreadData* thread(int id) const noexcept {
+        return threads_[id].get();
+    }
+    [[nodiscard]] const std::optional<std::chrono::milliseconds>& start_time() const noexcept {
+        return start_time_;
     }
     [[nodiscard]] const std::optional<loltaxx::UAIGoParameters>& go_parameters() const noexcept {
         return go_parameters_;
     }
+    // The table the search uses, the engine-wide one unless set
+    [[nodiscard]] TranspositionTable* tt() const noexcept {
+        return tt_;
+    }
+    [[nodiscard]] SearchDriver driver() const noexcept {
+        return driver_;
+    }
+    [[nodiscard]] int multipv() const noexcept {
+        return multipv_;
+    }
+    // Score of the move returned by the last search, for the side to move
+    [[nodiscard]] int score() const noexcept {
+        return score_;
+    }
+    // Principal variation of the last search, starting with the move returned
+    [[nodiscard]] const loltaxx::MoveList& pv() const noexcept {
+        return pv_;
+    }
+    [[nodiscard]] bool verbose() const noexcept {
+        return verbose_;
+    }
+    [[nodiscard]] bool null_move_pruning() const noexcept {
+        return null_move_pruning_;
+    }
+    [[nodiscard]] bool late_move_reductions() const noexcept {
+        return late_move_reductions_;
+    }
+    [[nodiscard]] bool reverse_futility_pruning() const noexcept {
+        return reverse_futility_pruning_;
+    }
+    [[nodiscard]] bool eval_cache() const noexcept {
+        return eval_cache_;
+    }
+    // Whether the handcrafted eval adds its positional terms to material
+    [[nodiscard]] bool positional_eval() const noexcept {
+        return positional_eval_;
+    }
 
     void reset_nodes() noexcept {
-        nodes_ = 0;
+        for (auto& thread : threads_) {
+            thread->reset_nodes();
+        }
+    }
+    void reset_tbhits() noexcept {
+        for (auto& thread : threads_) {
+            thread->reset_tbhits();
+        }
+    }
+    // Frees the thread data, so it must not be called while a search is running
+    void set_num_threads(int num_threads) {
+        threads_.clear();
+        for (int id = 0; id < num_threads; ++id) {
+            threads_.push_back(std::make_unique<ThreadData>(id));
+        }
     }
     void set_start_time(std::chrono::milliseconds start_time) noexcept {
         start_time_ = start_time;
+        last_info_time_ = start_time;
+    }
+    void set_info_interval(std::chrono::milliseconds info_interval) noexcept {
+        info_interval_ = info_interval;
     }
     void set_go_parameters(const loltaxx::UAIGoParameters& go_parameters) noexcept {
         go_parameters_ = go_parameters;
@@ -66,24 +268,68 @@ class SearchGlobals {
     void set_side_to_move(loltaxx::Piece color) noexcept {
         side_to_move_ = color;
     }
+    void set_tt(TranspositionTable* tt) noexcept {
+        tt_ = tt;
+    }
+    void set_driver(SearchDriver driver) noexcept {
+        driver_ = driver;
+    }
+    void set_multipv(int multipv) noexcept {
+        multipv_ = std::clamp(multipv, 1, MAX_MULTIPV);
+    }
+    void set_score(int score) noexcept {
+        score_ = score;
+    }
+    void set_pv(const loltaxx::MoveList& pv) noexcept {
+        pv_ = pv;
+    }
+    void set_verbose(bool verbose) noexcept {
+        verbose_ = verbose;
+    }
+    void set_null_move_pruning(bool null_move_pruning) noexcept {
+        null_move_pruning_ = null_move_pruning;
+    }
+    void set_late_move_reductions(bool late_move_reductions) noexcept {
+        late_move_reductions_ = late_move_reductions;
+    }
+    void set_reverse_futility_pruning(bool reverse_futility_pruning) noexcept {
+        reverse_futility_pruning_ = reverse_futility_pruning;
+    }
+    void set_eval_cache(bool eval_cache) noexcept {
+        eval_cache_ = eval_cache;
+    }
+    void set_positional_eval(bool positional_eval) noexcept {
+        positional_eval_ = positional_eval;
+    }
 
     static SearchGlobals new_search_globals(
         const std::optional<std::chrono::milliseconds>& start_time = {},
         const std::optional<loltaxx::UAIGoParameters>& go_parameters = {}) noexcept {
-        return SearchGlobals{0, start_time, go_parameters};
+        return SearchGlobals{start_time, go_parameters};
     }
 
-    void increment_nodes() noexcept {
-        ++nodes_;
+    // Rate limits periodic progress output to one line per info interval
+    [[nodiscard]] bool info_due(std::chrono::milliseconds now) noexcept {
+        if (now - last_info_time_ < info_interval_) {
+            return false;
+        }
+        last_info_time_ = now;
+        return true;
     }
-    [[nodiscard]] bool stop() noexcept {
+    // Limits are only checked by the main thread, helpers just follow the stop flag
+    [[nodiscard]] bool stop(const ThreadData* td) noexcept {
         if (stop_flag_) {
             return true;
         }
-        if (!go_parameters_) {
+        if (!go_parameters_ || !td->main_thread()) {
             return false;
         }
-        if (!(nodes_ & 4095U) && start_time_) {
+        // Node limits are checked on every node, fixed-node searches can be much smaller than the
+        // interval between clock reads
+        if (go_parameters_->nodes() && !go_parameters_->infinite() &&
+            nodes() >= *go_parameters_->nodes()) {
+            stop_flag_ = true;
+        } else if (!(td->nodes() & 4095U) && start_time_) {
             auto time_diff = curr_time().count() - start_time_->count();
 
             auto time = [this]() {
@@ -127,11 +373,28 @@ class SearchGlobals {
    private:
     loltaxx::Piece side_to_move_;
     std::atomic<bool> stop_flag_;
-    std::atomic<std::uint64_t> nodes_;
+    std::vector<std::unique_ptr<ThreadData>> threads_;
     std::optional<std::chrono::milliseconds> start_time_;
     std::optional<loltaxx::UAIGoParameters> go_parameters_;
+    std::chrono::milliseconds info_interval_;
+    std::chrono::milliseconds last_info_time_;
+    SearchDriver driver_;
+    TranspositionTable* tt_;
+    int multipv_;
+    int score_;
+    loltaxx::MoveList pv_;
+    bool verbose_;
+    bool null_move_pruning_;
+    bool late_move_reductions_;
+    bool reverse_futility_pruning_;
+    bool eval_cache_;
+    bool positional_eval_;
 };
 
+// Reallocates the shared TT, so it must not be called while a search is running
+extern void set_hash_size(int mb);
+extern void clear_hash();
+extern bool set_tablebase_path(const std::string& path);
 extern SearchResult search(Position pos, int depth);
 extern std::optional<loltaxx::Move> best_move_search(loltaxx::Position pos,
                                                      SearchGlobals* search_globals);
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 #include "file.h"
 #include "rank.h"
@@ -51,10 +52,16 @@ class Square : public MetaValueType<int> {
         if (!(file && rank)) {
             return {};
         }
-        return Square{*file | (*rank << 3)};
+        return Square{*file + *rank * 7};
     }
-    static std::optional<Square> from(const std::string& square_str) {
-        return Square::from(File::from(square_str[0]), Rank::from(square_str[1]));
+    constexpr static std::optional<Square> from(char file_char, char rank_char) {
+        return Square::from(File::from(file_char), Rank::from(rank_char));
+    }
+    constexpr static std::optional<Square> from(std::string_view square_str) {
+        if (square_str.length() < 2) {
+            return {};
+        }
+        return Square::from(square_str[0], square_str[1]);
     }
 };
 
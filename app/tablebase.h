@@ -0,0 +1,272 @@
+#ifndef LOLTAXX_TABLEBASE_H
+#define LOLTAXX_TABLEBASE_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "mapped_file.h"
+#include "position.h"
+
+namespace loltaxx {
+
+// A tablebase holds every position of one gap layout, as clones add pieces and no smaller set of
+// positions is closed under moves. Positions are indexed by a base-3 digit per playable square
+// (empty, cross, knot) and the side to move. Each entry packs the result for the side to move
+// with the number of plies until the game ends. The halfmove clock is ignored, positions which
+// only cycle are draws.
+class Tablebase {
+   public:
+    enum Result : std::uint16_t
+    {
+        UNKNOWN = 0,
+        LOSS = 1,
+        DRAW = 2,
+        WIN = 3
+    };
+
+    struct Entry {
+        Result result;
+        int distance;
+    };
+
+    constexpr static int MAX_SQUARES = 16;
+
+   private:
+    constexpr static char MAGIC[8]{'L', 'T', 'X', 'T', 'B', '\0', '\0', '\0'};
+    constexpr static std::uint32_t VERSION = 1;
+    constexpr static int MAX_DISTANCE = 0x3fff;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t num_squares;
+        std::uint64_t gaps;
+        std::uint64_t num_entries;
+    };
+
+   public:
+    Tablebase() = default;
+    Tablebase(const Tablebase&) = delete;
+    Tablebase& operator=(const Tablebase&) = delete;
+
+    ~Tablebase() {
+        unload();
+    }
+
+    bool load(const std::string& path) {
+        unload();
+        if (!file_.open(path) || file_.size() < sizeof(Header)) {
+            file_.close();
+            return false;
+        }
+
+        Header header{};
+        std::memcpy(&header, file_.data(), sizeof(Header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+            header.num_squares > MAX_SQUARES ||
+            header.num_squares != playable_squares(Bitboard{header.gaps}).size() ||
+            header.num_entries != num_entries(header.num_squares) ||
+            file_.size() < sizeof(Header) + header.num_entries * sizeof(std::uint16_t)) {
+            file_.close();
+            return false;
+        }
+
+        entries_ = reinterpret_cast<const std::uint16_t*>(file_.data() + sizeof(Header));
+        gaps_ = Bitboard{header.gaps};
+        squares_ = playable_squares(gaps_);
+        return true;
+    }
+    void unload() {
+        file_.close();
+        entries_ = nullptr;
+        squares_.clear();
+    }
+
+    [[nodiscard]] bool loaded() const noexcept {
+        return entries_ != nullptr;
+    }
+    [[nodiscard]] std::optional<Entry> probe(const Position& pos) const noexcept {
+        if (!entries_ || pos.gaps() != gaps_) {
+            return {};
+        }
+        return decode(entries_[index(squares_, pos)]);
+    }
+
+    [[nodiscard]] static std::vector<Square> playable_squares(Bitboard gaps) {
+        std::vector<Square> squares;
+        for (Square sq : Bitboard::Iterator{~gaps & Bitboard::full()}) {
+            squares.push_back(sq);
+        }
+        return squares;
+    }
+    [[nodiscard]] static std::uint64_t num_entries(std::size_t num_squares) noexcept {
+        std::uint64_t entries = 2;
+        for (std::size_t i = 0; i < num_squares; ++i) {
+            entries *= 3;
+        }
+        return entries;
+    }
+    [[nodiscard]] static std::uint64_t index(const std::vector<Square>& squares,
+                                             const Position& pos) noexcept {
+        Bitboard crosses = pos.pieces(constants::CROSS);
+        Bitboard knots = pos.pieces(constants::KNOT);
+        std::uint64_t idx = 0;
+        for (auto it = squares.rbegin(); it != squares.rend(); ++it) {
+            Bitboard bb{*it};
+            idx = idx * 3 + ((crosses & bb) ? 1 : (knots & bb) ? 2 : 0);
+        }
+        return idx * 2 + pos.side_to_move().value();
+    }
+    [[nodiscard]] static Position position(const std::vector<Square>& squares,
+                                           Bitboard gaps,
+                                           std::uint64_t idx) {
+        Piece side_to_move{int(idx % 2)};
+        idx /= 2;
+        Bitboard crosses;
+        Bitboard knots;
+        for (Square sq : squares) {
+            int digit = int(idx % 3);
+            idx /= 3;
+            if (digit == 1) {
+                crosses |= Bitboard{sq};
+            } else if (digit == 2) {
+                knots |= Bitboard{sq};
+            }
+        }
+        return Position{crosses, knots, gaps, side_to_move};
+    }
+
+    // Retrograde analysis: finished games are resolved first, then each round resolves the
+    // positions with a move to a lost position, or with every move leading to a won one. Rounds
+    // only read results from earlier rounds, so the index range is split between threads and the
+    // new results are applied once all of them finish.
+    [[nodiscard]] static std::vector<std::uint16_t> generate(Bitboard gaps, int num_threads) {
+        std::vector<Square> squares = playable_squares(gaps);
+        std::vector<std::uint16_t> table(num_entries(squares.size()), encode({UNKNOWN, 0}));
+
+        auto run_round = [&](int distance) {
+            std::vector<std::vector<std::pair<std::uint64_t, Entry>>> updates(num_threads);
+            std::vector<std::thread> threads;
+            std::uint64_t chunk = (table.size() + num_threads - 1) / num_threads;
+            for (int id = 0; id < num_threads; ++id) {
+                threads.emplace_back([&, id]() {
+                    std::uint64_t end = std::min<std::uint64_t>(table.size(), (id + 1) * chunk);
+                    for (std::uint64_t idx = id * chunk; idx < end; ++idx) {
+                        if (decode(table[idx]).result != UNKNOWN) {
+                            continue;
+                        }
+                        Position pos = position(squares, gaps, idx);
+                        auto entry = distance ? resolve(squares, table, pos, distance)
+                                              : game_over(pos);
+                        if (entry) {
+                            updates[id].emplace_back(idx, *entry);
+                        }
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            std::uint64_t resolved = 0;
+            for (const auto& thread_updates : updates) {
+                for (const auto& [idx, entry] : thread_updates) {
+                    table[idx] = encode(entry);
+                }
+                resolved += thread_updates.size();
+            }
+            return resolved;
+        };
+
+        run_round(0);
+        for (int distance = 1; run_round(distance); ++distance) {
+        }
+        for (auto& entry : table) {
+            if (decode(entry).result == UNKNOWN) {
+                entry = encode({DRAW, 0});
+            }
+        }
+        return table;
+    }
+
+    static bool write(const std::string& path,
+                      Bitboard gaps,
+                      const std::vector<std::uint16_t>& table) {
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.num_squares = std::uint32_t(playable_squares(gaps).size());
+        header.gaps = gaps;
+        header.num_entries = table.size();
+
+        std::ofstream file{path, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char*>(table.data()),
+                   std::streamsize(table.size() * sizeof(std::uint16_t)));
+        return bool(file);
+    }
+
+    [[nodiscard]] constexpr static std::uint16_t encode(Entry entry) noexcept {
+        return std::uint16_t(entry.result | std::min(entry.distance, MAX_DISTANCE) << 2);
+    }
+    [[nodiscard]] constexpr static Entry decode(std::uint16_t entry) noexcept {
+        return Entry{Result(entry & 0x3), entry >> 2};
+    }
+
+   private:
+
+    // The game ends when a side has no pieces left, or when neither side can move, which
+    // includes a full board
+    [[nodiscard]] static std::optional<Entry> game_over(const Position& pos) {
+        Piece stm = pos.side_to_move();
+        Bitboard us = pos.pieces(stm);
+        Bitboard them = pos.pieces(!stm);
+        Bitboard empty = pos.empty_squares();
+        if (!us) {
+            return Entry{LOSS, 0};
+        }
+        if (!them) {
+            return Entry{WIN, 0};
+        }
+        if ((us.adjacent() | us.jumps() | them.adjacent() | them.jumps()) & empty) {
+            return {};
+        }
+        int difference = us.popcount() - them.popcount();
+        return Entry{difference > 0 ? WIN : difference < 0 ? LOSS : DRAW, 0};
+    }
+
+    [[nodiscard]] static std::optional<Entry> resolve(const std::vector<Square>& squares,
+                                                      const std::vector<std::uint16_t>& table,
+                                                      const Position& pos,
+                                                      int distance) {
+        bool all_won = true;
+        for (Move move : pos.legal_moves()) {
+            Position child = pos;
+            child.make_move(move);
+            Result result = decode(table[index(squares, child)]).result;
+            if (result == LOSS) {
+                return Entry{WIN, distance};
+            }
+            all_won &= result == WIN;
+        }
+        if (all_won) {
+            return Entry{LOSS, distance};
+        }
+        return {};
+    }
+
+    MappedFile file_;
+    const std::uint16_t* entries_ = nullptr;
+    Bitboard gaps_;
+    std::vector<Square> squares_;
+};
+
+}  // namespace loltaxx
+
+#endif  // LOLTAXX_TABLEBASE_H
@@ -0,0 +1,53 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "CLI11/CLI11.hpp"
+
+#include "position.h"
+#include "tablebase.h"
+
+using loltaxx::Position;
+using loltaxx::Tablebase;
+
+int main(int argc, char** argv) {
+    std::string layout;
+    std::string output;
+    int num_threads = int(std::max(1U, std::thread::hardware_concurrency()));
+
+    CLI::App app{"Generates the tablebase of every position on one gap layout."};
+    app.add_option("-l,--layout", layout, "Board part of a FEN, '-' marks the gaps.")->required();
+    app.add_option("-o,--output", output, "Tablebase file to write.")->required();
+    app.add_option("-t,--threads", num_threads, "Threads to use.", true);
+    CLI11_PARSE(app, argc, argv);
+
+    Position layout_pos{layout + " x 0"};
+    auto gaps = layout_pos.gaps();
+    auto num_squares = int(Tablebase::playable_squares(gaps).size());
+    if (num_squares > Tablebase::MAX_SQUARES) {
+        std::cerr << "Layout has " << num_squares << " playable squares, at most "
+                  << Tablebase::MAX_SQUARES << " are supported\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto table = Tablebase::generate(gaps, std::max(1, num_threads));
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    std::uint64_t counts[4]{};
+    for (auto entry : table) {
+        ++counts[Tablebase::decode(entry).result];
+    }
+    std::cout << "Positions : " << table.size() << "\n"
+              << "Wins      : " << counts[Tablebase::WIN] << "\n"
+              << "Draws     : " << counts[Tablebase::DRAW] << "\n"
+              << "Losses    : " << counts[Tablebase::LOSS] << "\n"
+              << "Time (ms) : " << elapsed.count() << "\n";
+
+    if (!Tablebase::write(output, gaps, table)) {
+        std::cerr << "Could not write " << output << "\n";
+        return 1;
+    }
+    return 0;
+}
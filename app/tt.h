@@ -25,6 +25,7 @@ SOFTWARE.
 #ifndef TT_H
 #define TT_H
 
+#include <algorithm>
 #include <cinttypes>
 #include <memory>
 
@@ -40,7 +41,7 @@ enum TTConstants
 
     MOVE_MASK = 0x1fffff,
     FLAG_MASK = 0x3,
-    DEPTH_MASK = 0x7,
+    DEPTH_MASK = 0x1ff,
 
     CLUSTER_SIZE = 1
 };
@@ -57,6 +58,7 @@ struct TTEntry {
     int get_flag() const;
     int get_depth() const;
     int get_score() const;
+    bool empty() const;
     void clear();
 
    private:
@@ -89,12 +91,16 @@ inline int TTEntry::get_depth() const {
 inline int TTEntry::get_score() const {
     return int(data >> SCORE_SHIFT);
 }
+inline bool TTEntry::empty() const {
+    return !(key | data);
+}
 inline void TTEntry::clear() {
     key = data = 0;
 }
 
 struct TTCluster {
     TTEntry& get_entry(std::uint64_t key);
+    int used() const;
     void clear();
 
    private:
@@ -116,6 +122,13 @@ inline TTEntry& TTCluster::get_entry(std::uint64_t key) {
     return entries[min_depth_index];
 }
 
+inline int TTCluster::used() const {
+    int count = 0;
+    for (const TTEntry& entry : entries)
+        count += !entry.empty();
+    return count;
+}
+
 inline void TTCluster::clear() {
     for (TTEntry& entry : entries)
         entry.clear();
@@ -134,6 +147,7 @@ struct TranspositionTable {
                std::uint64_t key);
     void clear();
     int hash(std::uint64_t key) const;
+    int hashfull() const;
 
    private:
     TTCluster* table;
@@ -175,6 +189,16 @@ inline int TranspositionTable::hash(std::uint64_t key) const {
     return key % size;
 }
 
+// Permille of used entries, sampled from the start of the table
+inline int TranspositionTable::hashfull() const {
+    int sample_size = std::min(size, 1000);
+    int used = 0;
+    for (int i = 0; i < sample_size; ++i) {
+        used += table[i].used();
+    }
+    return used * 1000 / (sample_size * CLUSTER_SIZE);
+}
+
 inline TTEntry TranspositionTable::probe(std::uint64_t key) const {
     int index = hash(key);
     return table[index].get_entry(key);
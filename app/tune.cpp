@@ -0,0 +1,395 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "CLI11/CLI11.hpp"
+
+#include "eval.h"
+#include "packed_position.h"
+#include "patterns.h"
+
+using namespace loltaxx;
+
+namespace {
+
+// The tuned evals are material plus a sparse sum of weights, each times a coefficient taken from
+// the position
+struct Feature {
+    int index;
+    double value;
+};
+using Features = std::vector<Feature>;
+using FeatureFunction = void (*)(const PackedPosition&, Features*);
+
+struct TuneParameters {
+    double k;
+    double lambda;
+    FeatureFunction features;
+};
+
+// The eval as the engine computes it with patterns loaded, one weight per pattern index
+void pattern_features(const PackedPosition& packed, Features* features) {
+    patterns::Indices indices;
+    patterns::refresh(packed.crosses(), packed.knots(), &indices);
+    features->clear();
+    for (int pattern = 0; pattern < patterns::NUM_PATTERNS; ++pattern) {
+        features->push_back(Feature{patterns::OFFSETS[pattern] + indices.values[pattern], 1.0});
+    }
+}
+
+// The handcrafted eval with PositionalEval set. Squares the symmetries of the board map onto each
+// other share their piece-square value, which leaves ten of them.
+constexpr int NUM_SQUARE_CLASSES = 10;
+enum HandcraftedWeight {
+    CLONE_WEIGHT = NUM_SQUARE_CLASSES,
+    JUMP_WEIGHT,
+    FRONTIER_WEIGHT,
+    HOLE_WEIGHT,
+    NUM_HANDCRAFTED_WEIGHTS
+};
+
+int square_class(int sq) {
+    int rank = std::min(sq / 7, 6 - sq / 7);
+    int file = std::min(sq % 7, 6 - sq % 7);
+    int high = std::max(rank, file);
+    return high * (high + 1) / 2 + std::min(rank, file);
+}
+
+void handcrafted_features(const PackedPosition& packed, Features* features) {
+    Bitboard crosses = packed.crosses();
+    Bitboard knots = packed.knots();
+    Bitboard empty = ~(crosses | knots | packed.gaps()) & Bitboard::full();
+
+    double squares[NUM_SQUARE_CLASSES] = {};
+    for (Square sq : Bitboard::Iterator{crosses}) {
+        squares[square_class(sq)] += 1.0;
+    }
+    for (Square sq : Bitboard::Iterator{knots}) {
+        squares[square_class(sq)] -= 1.0;
+    }
+    features->clear();
+    for (int square = 0; square < NUM_SQUARE_CLASSES; ++square) {
+        if (squares[square] != 0.0) {
+            features->push_back(Feature{square, squares[square]});
+        }
+    }
+
+    PositionalTerms cross_terms = positional_terms(crosses, knots, empty);
+    PositionalTerms knot_terms = positional_terms(knots, crosses, empty);
+    features->push_back(Feature{CLONE_WEIGHT, double(cross_terms.clones - knot_terms.clones)});
+    features->push_back(Feature{JUMP_WEIGHT, double(cross_terms.jumps - knot_terms.jumps)});
+    features->push_back(
+        Feature{FRONTIER_WEIGHT, double(knot_terms.frontier - cross_terms.frontier)});
+    features->push_back(Feature{HOLE_WEIGHT, double(knot_terms.holes - cross_terms.holes)});
+}
+
+// Starts from the values compiled in
+std::vector<double> handcrafted_weights() {
+    std::vector<double> weights(NUM_HANDCRAFTED_WEIGHTS, 0.0);
+    std::vector<int> counts(NUM_SQUARE_CLASSES, 0);
+    for (int sq = 0; sq < 49; ++sq) {
+        weights[square_class(sq)] += constants::PIECE_SQUARE_VALUES[sq];
+        ++counts[square_class(sq)];
+    }
+    for (int square = 0; square < NUM_SQUARE_CLASSES; ++square) {
+        weights[square] /= counts[square];
+    }
+    weights[CLONE_WEIGHT] = constants::CLONE_MOBILITY_BONUS;
+    weights[JUMP_WEIGHT] = constants::JUMP_MOBILITY_BONUS;
+    weights[FRONTIER_WEIGHT] = constants::FRONTIER_PENALTY;
+    weights[HOLE_WEIGHT] = constants::HOLE_PENALTY;
+    return weights;
+}
+
+struct Adam {
+    static constexpr double BETA1 = 0.9;
+    static constexpr double BETA2 = 0.999;
+    static constexpr double EPSILON = 1e-8;
+
+    Adam(double learning_rate, std::size_t num_weights)
+        : learning_rate(learning_rate), m(num_weights), v(num_weights) {
+    }
+
+    void step(const std::vector<double>& gradient, std::vector<double>* weights) {
+        ++t;
+        double correction1 = 1.0 - std::pow(BETA1, t);
+        double correction2 = 1.0 - std::pow(BETA2, t);
+        for (std::size_t i = 0; i < m.size(); ++i) {
+            m[i] = BETA1 * m[i] + (1.0 - BETA1) * gradient[i];
+            v[i] = BETA2 * v[i] + (1.0 - BETA2) * gradient[i] * gradient[i];
+            (*weights)[i] -=
+                learning_rate * (m[i] / correction1) / (std::sqrt(v[i] / correction2) + EPSILON);
+        }
+    }
+
+    double learning_rate;
+    std::vector<double> m;
+    std::vector<double> v;
+    int t = 0;
+};
+
+double sigmoid(double x) {
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+// Eval for crosses, with the features filled in for the gradient
+double evaluate(const PackedPosition& packed,
+                const std::vector<double>& weights,
+                const TuneParameters& parameters,
+                Features* features) {
+    parameters.features(packed, features);
+    double eval = PIECE_VALUE * (packed.crosses().popcount() - packed.knots().popcount());
+    for (const Feature& feature : *features) {
+        eval += weights[feature.index] * feature.value;
+    }
+    return eval;
+}
+
+// Blend of the game result and the search score, both for crosses
+double target(const PackedPosition& packed, const TuneParameters& parameters) {
+    double result = packed.result / 2.0;
+    if (parameters.lambda >= 1.0) {
+        return result;
+    }
+    double score = packed.side_to_move() == constants::CROSS ? packed.score : -packed.score;
+    return parameters.lambda * result + (1.0 - parameters.lambda) * sigmoid(parameters.k * score);
+}
+
+// Cross-entropy of sigmoid(logit) against the target, in a form which stays exact when the
+// sigmoid saturates
+double cross_entropy(double logit, double target) {
+    return std::max(logit, 0.0) - logit * target + std::log1p(std::exp(-std::abs(logit)));
+}
+
+// Mean logistic loss over the positions, and its gradient with respect to every weight when one
+// is passed. Threads take contiguous slices and keep their own gradients, summed at the end.
+double loss(const std::vector<PackedPosition>& positions,
+            const std::vector<double>& weights,
+            const TuneParameters& parameters,
+            int num_threads,
+            std::vector<double>* gradient) {
+    std::vector<double> thread_losses(num_threads);
+    std::vector<std::vector<double>> thread_gradients(gradient ? num_threads : 0);
+    std::vector<std::thread> threads;
+    std::size_t slice = (positions.size() + num_threads - 1) / num_threads;
+    for (int id = 0; id < num_threads; ++id) {
+        threads.emplace_back([&, id]() {
+            std::size_t begin = std::min(positions.size(), id * slice);
+            std::size_t end = std::min(positions.size(), begin + slice);
+            if (gradient) {
+                thread_gradients[id].assign(weights.size(), 0.0);
+            }
+            double total = 0.0;
+            Features features;
+            for (std::size_t i = begin; i < end; ++i) {
+                double logit =
+                    parameters.k * evaluate(positions[i], weights, parameters, &features);
+                double expected = target(positions[i], parameters);
+                total += cross_entropy(logit, expected);
+                if (gradient) {
+                    double delta = parameters.k * (sigmoid(logit) - expected);
+                    for (const Feature& feature : features) {
+                        thread_gradients[id][feature.index] += delta * feature.value;
+                    }
+                }
+            }
+            thread_losses[id] = total;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double total = 0.0;
+    for (double thread_loss : thread_losses) {
+        total += thread_loss;
+    }
+    if (gradient) {
+        double scale = 1.0 / double(positions.size());
+        gradient->assign(weights.size(), 0.0);
+        for (const auto& thread_gradient : thread_gradients) {
+            for (std::size_t i = 0; i < weights.size(); ++i) {
+                (*gradient)[i] += thread_gradient[i] * scale;
+            }
+        }
+    }
+    return total / double(positions.size());
+}
+
+// Golden-section search over log10(K) for the sigmoid scale that best predicts the results with
+// the initial weights, so that the tuned weights stay in eval units
+double fit_k(const std::vector<PackedPosition>& positions,
+             const std::vector<double>& weights,
+             FeatureFunction features,
+             int num_threads) {
+    const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+    double low = -6.0;
+    double high = -1.0;
+    auto loss_at = [&](double log_k) {
+        return loss(positions, weights, TuneParameters{std::pow(10.0, log_k), 1.0, features},
+                    num_threads, nullptr);
+    };
+    for (int iteration = 0; iteration < 40; ++iteration) {
+        double left = high - ratio * (high - low);
+        double right = low + ratio * (high - low);
+        if (loss_at(left) < loss_at(right)) {
+            high = right;
+        } else {
+            low = left;
+        }
+    }
+    return std::pow(10.0, (low + high) / 2.0);
+}
+
+// The positions of all inputs are copied into one array for the threads to slice
+bool read_positions(const std::string& path, std::vector<PackedPosition>* positions) {
+    PackedReader reader;
+    if (!reader.open(path)) {
+        return false;
+    }
+    positions->insert(positions->end(), reader.begin(), reader.end());
+    return true;
+}
+
+bool write_pattern_weights(const std::string& path, const std::vector<double>& weights) {
+    for (int i = 0; i < patterns::NUM_WEIGHTS; ++i) {
+        patterns::weights[i] = std::int16_t(std::clamp(std::lround(weights[i]), -32767L, 32767L));
+    }
+    return patterns::write(path);
+}
+
+// Writes internal/eval_params.h as it is laid out by hand, to be built into the engine
+bool write_handcrafted_weights(const std::string& path, const std::vector<double>& weights) {
+    std::ofstream file{path};
+    file << "#ifndef LOLTAXX_INTERNAL_EVAL_PARAMS_H\n"
+            "#define LOLTAXX_INTERNAL_EVAL_PARAMS_H\n"
+            "\n"
+            "#include <array>\n"
+            "\n"
+            "// Parameters of the positional terms of the handcrafted eval, written by tune "
+            "--handcrafted.\n"
+            "namespace loltaxx::constants {\n"
+            "\n"
+            "// The table is the same for both sides, the board looks alike from either one.\n"
+            "constexpr std::array<int, 49> PIECE_SQUARE_VALUES = {\n";
+    for (int rank = 0; rank < 7; ++rank) {
+        for (int file_index = 0; file_index < 7; ++file_index) {
+            file << (file_index ? " " : "    ") << std::setw(2)
+                 << std::lround(weights[square_class(rank * 7 + file_index)]) << ',';
+        }
+        file << '\n';
+    }
+    file << "};\n"
+            "\n"
+         << "constexpr int FRONTIER_PENALTY = " << std::lround(weights[FRONTIER_WEIGHT]) << ";\n"
+         << "constexpr int CLONE_MOBILITY_BONUS = " << std::lround(weights[CLONE_WEIGHT]) << ";\n"
+         << "constexpr int JUMP_MOBILITY_BONUS = " << std::lround(weights[JUMP_WEIGHT]) << ";\n"
+         << "constexpr int HOLE_PENALTY = " << std::lround(weights[HOLE_WEIGHT]) << ";\n"
+         << "\n"
+            "}  // namespace loltaxx::constants\n"
+            "\n"
+            "#endif  // LOLTAXX_INTERNAL_EVAL_PARAMS_H\n";
+    return bool(file.flush());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> inputs;
+    std::string output;
+    std::string initial;
+    int epochs = 200;
+    int checkpoint = 50;
+    double learning_rate = 1.0;
+    double k = 0.0;
+    double lambda = 1.0;
+    int num_threads = int(std::max(1U, std::thread::hardware_concurrency()));
+
+    bool handcrafted = false;
+
+    CLI::App app{"Tunes the pattern or handcrafted eval weights on labelled positions with Adam."};
+    app.add_option("-i,--input", inputs, "Packed position files.")->required();
+    app.add_option("-o,--output", output, "Pattern file or parameter header to write.")
+        ->required();
+    auto* init_option =
+        app.add_option("--init", initial, "Pattern file to start from instead of zeroes.");
+    app.add_flag("--handcrafted", handcrafted,
+                 "Tune the positional terms instead, from the values built in, and write them "
+                 "as app/internal/eval_params.h to build with.")
+        ->excludes(init_option);
+    app.add_option("-e,--epochs", epochs, "Full passes over the positions.", true);
+    app.add_option("-c,--checkpoint", checkpoint, "Epochs between writes of the output.", true);
+    app.add_option("-l,--learning-rate", learning_rate, "Adam step size in eval units.", true);
+    app.add_option("-k", k, "Sigmoid scale, fitted to the results when 0.", true);
+    app.add_option("--lambda", lambda, "Weight of the result against the search score.", true);
+    app.add_option("-t,--threads", num_threads, "Threads to compute the gradient with.", true);
+    CLI11_PARSE(app, argc, argv);
+    num_threads = std::clamp(num_threads, 1, 256);
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&start]() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    };
+
+    std::vector<PackedPosition> positions;
+    for (const auto& path : inputs) {
+        if (!read_positions(path, &positions)) {
+            std::cerr << "Could not read " << path << "\n";
+            return 1;
+        }
+    }
+    if (positions.empty()) {
+        std::cerr << "No positions to tune on\n";
+        return 1;
+    }
+    std::cout << "Positions : " << positions.size() << "\n"
+              << "Load (ms) : " << elapsed() << std::endl;
+
+    FeatureFunction features = handcrafted ? handcrafted_features : pattern_features;
+    auto write_weights = handcrafted ? write_handcrafted_weights : write_pattern_weights;
+    std::vector<double> weights =
+        handcrafted ? handcrafted_weights() : std::vector<double>(patterns::NUM_WEIGHTS, 0.0);
+    if (!initial.empty()) {
+        if (!patterns::load(initial)) {
+            std::cerr << "Could not load " << initial << "\n";
+            return 1;
+        }
+        std::copy(patterns::weights, patterns::weights + patterns::NUM_WEIGHTS, weights.begin());
+    }
+
+    if (k <= 0.0) {
+        k = fit_k(positions, weights, features, num_threads);
+    }
+    TuneParameters parameters{k, std::clamp(lambda, 0.0, 1.0), features};
+    std::cout << "K         : " << k << "\n";
+
+    Adam adam{learning_rate, weights.size()};
+    std::vector<double> gradient;
+    for (int epoch = 1; epoch <= epochs; ++epoch) {
+        auto epoch_start = std::chrono::steady_clock::now();
+        double epoch_loss = loss(positions, weights, parameters, num_threads, &gradient);
+        adam.step(gradient, &weights);
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch_start).count();
+
+        std::cout << "Epoch " << epoch << " loss " << epoch_loss << " positions/s "
+                  << std::uint64_t(positions.size() / std::max(seconds, 1e-9)) << std::endl;
+        if ((checkpoint > 0 && epoch % checkpoint == 0) || epoch == epochs) {
+            if (!write_weights(output, weights)) {
+                std::cerr << "Could not write " << output << "\n";
+                return 1;
+            }
+        }
+    }
+    std::cout << "Final loss : "
+              << loss(positions, weights, parameters, num_threads, nullptr) << "\n"
+              << "Time (ms)  : " << elapsed() << "\n";
+    return 0;
+}
@@ -0,0 +1,196 @@
+#ifndef LOLTAXX_UAIOUTPUT_H
+#define LOLTAXX_UAIOUTPUT_H
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+namespace loltaxx {
+
+// A fixed-capacity output line which formats without touching the heap, so the search thread can
+// build info lines as cheaply as possible. Anything past the capacity is dropped.
+class UAILine {
+   public:
+    constexpr static int MAX_LENGTH = 2047;
+
+    UAILine() noexcept : length_(0) {
+    }
+
+    UAILine& operator<<(std::string_view str) noexcept {
+        int count = std::min(int(str.length()), MAX_LENGTH - length_);
+        std::memcpy(data_ + length_, str.data(), count);
+        length_ += count;
+        return *this;
+    }
+    UAILine& operator<<(const char* str) noexcept {
+        return *this << std::string_view{str};
+    }
+    UAILine& operator<<(char c) noexcept {
+        if (length_ < MAX_LENGTH) {
+            data_[length_++] = c;
+        }
+        return *this;
+    }
+    template <class T, class = std::enable_if_t<std::is_integral_v<T>>>
+    UAILine& operator<<(T value) noexcept {
+        if constexpr (std::is_same_v<T, bool>) {
+            return *this << (value ? '1' : '0');
+        } else {
+            auto [end, error] = std::to_chars(data_ + length_, data_ + MAX_LENGTH, value);
+            if (error == std::errc{}) {
+                length_ = int(end - data_);
+            }
+            return *this;
+        }
+    }
+
+    void clear() noexcept {
+        length_ = 0;
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return length_ == 0;
+    }
+    [[nodiscard]] int length() const noexcept {
+        return length_;
+    }
+    [[nodiscard]] std::string_view str() const noexcept {
+        return {data_, std::size_t(length_)};
+    }
+
+   private:
+    char data_[MAX_LENGTH];
+    int length_;
+};
+
+// Engine output goes through a bounded lock-free queue of preallocated lines. A dedicated I/O
+// thread drains it with one write(2) per line, so threads emitting output never block on stdout.
+class UAIOutput {
+   private:
+    constexpr static std::size_t CAPACITY = 256;
+    constexpr static std::size_t INDEX_MASK = CAPACITY - 1;
+    constexpr static int SLOT_SIZE = UAILine::MAX_LENGTH + 1;
+
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        int length;
+        char data[SLOT_SIZE];
+    };
+
+   public:
+    static UAIOutput& instance() {
+        static UAIOutput output;
+        return output;
+    }
+
+    UAIOutput(const UAIOutput&) = delete;
+    UAIOutput& operator=(const UAIOutput&) = delete;
+
+    ~UAIOutput() {
+        running_ = false;
+        io_thread_.join();
+    }
+
+    // Queues the line and its terminating newline, waiting for space if the queue is full.
+    void write_line(std::string_view line) noexcept {
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots_[pos & INDEX_MASK];
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto diff = std::intptr_t(sequence) - std::intptr_t(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                std::this_thread::yield();
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        int length = std::min(int(line.length()), SLOT_SIZE - 1);
+        std::memcpy(slot->data, line.data(), length);
+        slot->data[length] = '\n';
+        slot->length = length + 1;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+    }
+    void write_line(const UAILine& line) noexcept {
+        write_line(line.str());
+    }
+
+   private:
+    UAIOutput() : enqueue_pos_(0), dequeue_pos_(0), running_(true) {
+        for (std::size_t i = 0; i < CAPACITY; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        io_thread_ = std::thread{[this]() { drain(); }};
+    }
+
+    bool write_next() noexcept {
+        Slot& slot = slots_[dequeue_pos_ & INDEX_MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+            return false;
+        }
+
+        const char* data = slot.data;
+        int remaining = slot.length;
+        while (remaining > 0) {
+            ssize_t written = ::write(STDOUT_FILENO, data, remaining);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            data += written;
+            remaining -= int(written);
+        }
+
+        slot.sequence.store(dequeue_pos_ + CAPACITY, std::memory_order_release);
+        ++dequeue_pos_;
+        return true;
+    }
+
+    void drain() noexcept {
+        constexpr std::chrono::microseconds MIN_BACKOFF{50};
+        constexpr std::chrono::microseconds MAX_BACKOFF{1000};
+
+        auto backoff = MIN_BACKOFF;
+        while (true) {
+            if (write_next()) {
+                backoff = MIN_BACKOFF;
+                continue;
+            }
+            if (!running_) {
+                // Producers are gone by now, so an empty queue stays empty
+                if (enqueue_pos_.load(std::memory_order_acquire) == dequeue_pos_) {
+                    break;
+                }
+                continue;
+            }
+            std::this_thread::sleep_for(backoff);
+            backoff = std::min(backoff * 2, MAX_BACKOFF);
+        }
+    }
+
+    Slot slots_[CAPACITY];
+    std::atomic<std::size_t> enqueue_pos_;
+    std::size_t dequeue_pos_;
+    std::atomic<bool> running_;
+    std::thread io_thread_;
+};
+
+}  // namespace loltaxx
+
+#endif  // LOLTAXX_UAIOUTPUT_H
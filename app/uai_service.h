@@ -2,6 +2,7 @@
 #define LOLTAXX_UAISERVICE_H
 
 #include "uai_option.h"
+#include "uai_output.h"
 
 #include <any>
 #include <atomic>
@@ -362,31 +363,43 @@ class UAIService {
             throw std::invalid_argument{"Must register a position, go and stop handler!"};
         }
 
-        std::cout << "id name " << name_ << "\n";
-        std::cout << "id author " << author_ << "\n";
+        UAIOutput& output = UAIOutput::instance();
+        UAILine line_out;
+        output.write_line(line_out << "id name " << name_);
+        line_out.clear();
+        output.write_line(line_out << "id author " << author_);
 
         for (auto& [name, option] : spin_options_) {
-            std::cout << "option name " << name << " type spin default " << option.value()
-                      << " min " << option.min_value() << " max " << option.max_value() << "\n";
+            line_out.clear();
+            line_out << "option name " << name << " type spin default " << option.value()
+                     << " min " << option.min_value() << " max " << option.max_value();
+            output.write_line(line_out);
         }
         for (auto& [name, option] : combo_options_) {
-            std::cout << "option name " << name << " type combo default " << option.value();
+            line_out.clear();
+            line_out << "option name " << name << " type combo default " << option.value();
             for (const auto& candidate : option.allowed_values()) {
-                std::cout << " var " << candidate;
+                line_out << " var " << candidate;
             }
-            std::cout << "\n";
+            output.write_line(line_out);
         }
         for (auto& [name, option] : string_options_) {
-            std::cout << "option name " << name << " type string default " << option.value()
-                      << "\n";
+            line_out.clear();
+            line_out << "option name " << name << " type string default " << option.value();
+            output.write_line(line_out);
         }
         for (auto& [name, option] : check_options_) {
-            std::cout << "option name " << name << " type check default " << option.value() << "\n";
+            line_out.clear();
+            line_out << "option name " << name << " type check default "
+                     << (option.value() ? "true" : "false");
+            output.write_line(line_out);
         }
         for (auto& [name, option] : button_options_) {
-            std::cout << "option name " << name << " type button\n";
+            line_out.clear();
+            line_out << "option name " << name << " type button";
+            output.write_line(line_out);
         }
-        std::cout << "uaiok\n";
+        output.write_line("uaiok");
 
         std::string word;
         std::string line;
@@ -402,7 +415,10 @@ class UAIService {
 
         keep_running_ = true;
         while (keep_running_) {
-            std::getline(std::cin, line);
+            if (!std::getline(std::cin, line)) {
+                stop_search();
+                break;
+            }
             std::istringstream line_stream{line};
             line_stream >> word;
             if (command_handlers_.find(word) != command_handlers_.end()) {
@@ -422,9 +438,12 @@ class UAIService {
             } else if (word == "stop") {
                 stop_search();
             } else if (word == "setoption") {
+                // Options such as Threads, Hash and the eval files replace state the search
+                // threads are still reading
+                stop_search();
                 parse_and_run_setoption_line(line_stream);
             } else if (word == "isready") {
-                std::cout << "readyok\n";
+                output.write_line("readyok");
             } else if (word == "quit" || word == "exit") {
                 stop_search();
                 break;
@@ -466,92 +485,101 @@ class UAIService {
                 string_options_[name].set_option(value);
             }
         } else if (check_options_.find(name) != check_options_.end()) {
-            bool value = false;
+            std::string value;
             if (line_stream >> value) {
-                check_options_[name].set_option(value);
+                check_options_[name].set_option(value == "true" || value == "1");
             }
         }
     }
 
     static void bestmove(const std::string& move,
                          const std::optional<std::string>& ponder_move = {}) noexcept {
-        std::cout << "bestmove " << move;
+        UAILine line;
+        line << "bestmove " << move;
         if (ponder_move) {
-            std::cout << " ponder " << *ponder_move;
+            line << " ponder " << *ponder_move;
         }
-        std::cout << "\n";
+        UAIOutput::instance().write_line(line);
+    }
+    static void info(const UAILine& info_line) noexcept {
+        UAIOutput::instance().write_line(info_line);
     }
     static void info(const UAIInfoParameters& info_parameters) noexcept {
         if (info_parameters.empty()) {
             return;
         }
 
-        std::cout << "info";
+        UAIOutput& output = UAIOutput::instance();
+        UAILine line;
+        line << "info";
         if (info_parameters.score()) {
-            std::cout << " score cp " << *info_parameters.score();
+            line << " score cp " << *info_parameters.score();
         }
         if (info_parameters.depth()) {
-            std::cout << " depth " << *info_parameters.depth();
+            line << " depth " << *info_parameters.depth();
         }
         if (info_parameters.seldepth()) {
-            std::cout << " seldepth " << *info_parameters.seldepth();
+            line << " seldepth " << *info_parameters.seldepth();
         }
         if (info_parameters.time()) {
-            std::cout << " time " << *info_parameters.time();
+            line << " time " << *info_parameters.time();
         }
         if (info_parameters.nodes()) {
-            std::cout << " nodes " << *info_parameters.nodes();
+            line << " nodes " << *info_parameters.nodes();
         }
         if (info_parameters.currmove()) {
-            std::cout << " currmove " << *info_parameters.currmove();
+            line << " currmove " << *info_parameters.currmove();
         }
         if (info_parameters.currmovenumber()) {
-            std::cout << " currmovenumber " << *info_parameters.currmovenumber();
+            line << " currmovenumber " << *info_parameters.currmovenumber();
         }
         if (info_parameters.hashfull()) {
-            std::cout << " hashfull " << *info_parameters.hashfull();
+            line << " hashfull " << *info_parameters.hashfull();
         }
         if (info_parameters.nps()) {
-            std::cout << " nps " << *info_parameters.nps();
+            line << " nps " << *info_parameters.nps();
         }
         if (info_parameters.tbhits()) {
-            std::cout << " tbhits " << *info_parameters.tbhits();
+            line << " tbhits " << *info_parameters.tbhits();
         }
         if (info_parameters.cpuload()) {
-            std::cout << " cpuload " << *info_parameters.cpuload();
+            line << " cpuload " << *info_parameters.cpuload();
         }
         if (info_parameters.pv()) {
-            auto pv = *info_parameters.pv();
+            const auto& pv = *info_parameters.pv();
             if (!pv.empty()) {
-                std::cout << " pv " << pv.to_str();
+                line << " pv " << pv.to_str();
             }
         }
         if (info_parameters.refutation()) {
-            auto refutation = *info_parameters.refutation();
+            const auto& refutation = *info_parameters.refutation();
             if (!refutation.empty()) {
-                std::cout << " refutation " << refutation.to_str();
+                line << " refutation " << refutation.to_str();
             }
         }
         if (info_parameters.string()) {
-            std::cout << " string " << *info_parameters.string();
+            line << " string " << *info_parameters.string();
         }
-        std::cout << "\n";
+        output.write_line(line);
         if (info_parameters.multipv()) {
-            auto multipv = *info_parameters.multipv();
+            const auto& multipv = *info_parameters.multipv();
             for (unsigned long i = 0; i < multipv.size(); ++i) {
-                if (multipv.empty()) {
+                if (multipv[i].empty()) {
                     continue;
                 }
-                std::cout << "info multipv " << (i + 1) << " " << multipv[i].to_str() << "\n";
+                line.clear();
+                output.write_line(line << "info multipv " << (i + 1) << " " << multipv[i].to_str());
             }
         }
         if (info_parameters.currline()) {
-            auto currline = *info_parameters.currline();
+            const auto& currline = *info_parameters.currline();
             for (unsigned long i = 0; i < currline.size(); ++i) {
-                if (currline.empty()) {
+                if (currline[i].empty()) {
                     continue;
                 }
-                std::cout << "info currline " << (i + 1) << " " << currline[i].to_str() << "\n";
+                line.clear();
+                output.write_line(line << "info currline " << (i + 1) << " "
+                                       << currline[i].to_str());
             }
         }
     }
@@ -562,23 +590,26 @@ class UAIService {
         std::string tmp;
         line_stream >> tmp;
         if (tmp == "startpos") {
-            fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+            fen = "x5o/7/7/7/7/7/o5x x 0 1";
+            if (!(line_stream >> tmp) || tmp != "moves") {
+                return UAIPositionParameters{fen, {}};
+            }
         } else if (tmp != "fen") {
             return {};
         } else {
+            // FEN fields run until the optional "moves" token
             line_stream >> fen;
-            for (int i = 0; i < 5; ++i) {
-                line_stream >> tmp;
+            bool has_moves = false;
+            while (line_stream >> tmp) {
+                if (tmp == "moves") {
+                    has_moves = true;
+                    break;
+                }
                 fen += " " + tmp;
             }
-        }
-
-        if (!line_stream) {
-            return UAIPositionParameters{fen, {}};
-        }
-        line_stream >> tmp;
-        if (tmp != "moves") {
-            return UAIPositionParameters{fen, {}};
+            if (!has_moves) {
+                return UAIPositionParameters{fen, {}};
+            }
         }
 
         std::vector<std::string> moves;
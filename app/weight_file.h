@@ -0,0 +1,68 @@
+#ifndef LOLTAXX_WEIGHT_FILE_H
+#define LOLTAXX_WEIGHT_FILE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace loltaxx::weight_file {
+
+// Weight files start with an eight-byte magic, the format version and the dimensions the weights
+// were made for, followed by a reserved word and the raw weights
+struct Format {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::vector<std::uint32_t> dimensions;
+};
+
+inline std::vector<char> header(const Format& format) {
+    std::vector<char> bytes(format.magic.begin(), format.magic.end());
+    auto append = [&bytes](std::uint32_t value) {
+        const char* data = reinterpret_cast<const char*>(&value);
+        bytes.insert(bytes.end(), data, data + sizeof(value));
+    };
+    append(format.version);
+    for (std::uint32_t dimension : format.dimensions) {
+        append(dimension);
+    }
+    append(0);
+    return bytes;
+}
+
+// Reads into a copy so that a file of another format, or a truncated one, leaves the loaded
+// weights untouched
+inline bool load(const std::string& path, const Format& format, void* weights, std::size_t size) {
+    std::vector<char> expected = header(format);
+    std::vector<char> read(expected.size());
+    std::ifstream file{path, std::ios::binary};
+    if (!file.read(read.data(), std::streamsize(read.size())) ||
+        !std::equal(expected.begin(), expected.end() - sizeof(std::uint32_t), read.begin())) {
+        return false;
+    }
+
+    std::vector<char> loaded(size);
+    if (!file.read(loaded.data(), std::streamsize(size))) {
+        return false;
+    }
+    std::memcpy(weights, loaded.data(), size);
+    return true;
+}
+
+inline bool write(const std::string& path,
+                  const Format& format,
+                  const void* weights,
+                  std::size_t size) {
+    std::vector<char> bytes = header(format);
+    std::ofstream file{path, std::ios::binary};
+    file.write(bytes.data(), std::streamsize(bytes.size()));
+    file.write(static_cast<const char*>(weights), std::streamsize(size));
+    return bool(file);
+}
+
+}  // namespace loltaxx::weight_file
+
+#endif  // LOLTAXX_WEIGHT_FILE_H
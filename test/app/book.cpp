@@ -0,0 +1,42 @@
+#include <filesystem>
+#include <string>
+
+#include "catch2/catch.hpp"
+
+#include "app/book.h"
+
+using loltaxx::Book;
+using loltaxx::Move;
+using loltaxx::Position;
+
+TEST_CASE("Book probes return the heaviest legal move", "[Book]") {
+    Position startpos{loltaxx::constants::STARTPOS_FEN};
+    Position after_f1 = startpos;
+    after_f1.make_move(*Move::from("f1"));
+
+    auto record = [](const Position& pos, const char* move, std::uint16_t weight) {
+        return Book::Record{pos.hash(), std::uint16_t(Move::from(move)->value()), weight, 0};
+    };
+    std::vector<Book::Record> records{
+        record(startpos, "f1", 3),
+        record(startpos, "b7", 5),
+        // Not legal at the start, as if another position shared the hash
+        record(startpos, "d4", 9),
+        record(after_f1, "b1", 1),
+    };
+
+    std::string path = std::filesystem::temp_directory_path() / "loltaxx_book_test.book";
+    REQUIRE(Book::write(path, records));
+
+    Book book;
+    REQUIRE(book.load(path));
+    REQUIRE(book.size() == records.size());
+
+    auto [first, last] = book.records(startpos.hash());
+    REQUIRE(last - first == 3);
+    REQUIRE(book.probe(startpos) == Move::from("b7"));
+    REQUIRE(book.probe(after_f1) == Move::from("b1"));
+    REQUIRE(!book.probe(Position{"x5o/7/7/3x3/7/7/o5x o 0"}));
+
+    std::filesystem::remove(path);
+}
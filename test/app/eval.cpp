@@ -0,0 +1,39 @@
+#include <memory>
+
+#include "catch2/catch.hpp"
+
+#include "app/eval.h"
+#include "app/eval_cache.h"
+
+using loltaxx::Position;
+
+TEST_CASE("Evaluation is symmetric between the sides", "[Eval]") {
+    Position pos{"x4oo/1x5/1x5/3o1oo/4o2/3o3/4o2 x 2 1"};
+    Position mirrored{pos.pieces(loltaxx::constants::KNOT),
+                      pos.pieces(loltaxx::constants::CROSS),
+                      pos.gaps(),
+                      loltaxx::constants::KNOT};
+    REQUIRE(loltaxx::eval(&pos) == loltaxx::eval(&mirrored));
+}
+
+TEST_CASE("Eval cache returns stored scores for matching keys only", "[Eval]") {
+    auto cache = std::make_unique<loltaxx::EvalCache>();
+    std::uint64_t hash = 0x123456789abcdef0;
+    std::uint64_t same_slot = hash ^ (std::uint64_t(1) << 50);
+
+    REQUIRE(!cache->probe(0));
+    REQUIRE(!cache->probe(hash));
+    cache->store(hash, -42);
+    REQUIRE(cache->probe(hash) == -42);
+    REQUIRE(!cache->probe(hash ^ (std::uint64_t(1) << 40)));
+
+    cache->store(same_slot, 7);
+    REQUIRE(cache->probe(same_slot) == 7);
+    REQUIRE(!cache->probe(hash));
+    REQUIRE(cache->hits() == 2);
+    REQUIRE(cache->probes() == 6);
+
+    cache->clear();
+    REQUIRE(!cache->probe(same_slot));
+    REQUIRE(cache->probes() == 1);
+}
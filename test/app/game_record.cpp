@@ -0,0 +1,72 @@
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch2/catch.hpp"
+
+#include "app/game_record.h"
+
+using loltaxx::GameRecord;
+using loltaxx::MoveList;
+using loltaxx::PackedPosition;
+using loltaxx::Position;
+
+namespace {
+
+GameRecord random_game(const std::string& fen, std::mt19937_64* rng) {
+    GameRecord game;
+    game.start = Position{fen};
+    game.result = PackedPosition::Result((*rng)() % 3);
+    Position pos = game.start;
+    for (int ply = 0; ply < 300; ++ply) {
+        MoveList move_list = pos.legal_moves();
+        if (move_list.empty()) {
+            break;
+        }
+        game.moves.push_back(move_list[int((*rng)() % move_list.size())]);
+        pos.make_move(game.moves.back());
+    }
+    return game;
+}
+
+}  // namespace
+
+TEST_CASE("Games survive the game writer and the game reader", "[GameRecord]") {
+    std::mt19937_64 rng{48};
+    std::vector<GameRecord> written;
+    for (int i = 0; i < loltaxx::GameWriter::BLOCK_GAMES + 10; ++i) {
+        written.push_back(random_game(i % 3 ? loltaxx::constants::STARTPOS_FEN
+                                            : "x-1-1-o/x3ooo/-x-1-1-/7/-1-1-1-/5x1/o-1-1-x o 3",
+                                      &rng));
+    }
+
+    std::string path = std::filesystem::temp_directory_path() / "loltaxx_game_record_test.games";
+    {
+        loltaxx::GameWriter writer;
+        REQUIRE(writer.open(path));
+        for (const auto& game : written) {
+            REQUIRE(writer.write(game));
+        }
+        // A move that is not legal refuses the game and leaves the others intact
+        GameRecord illegal;
+        illegal.moves.push_back(*loltaxx::Move::from("d4"));
+        REQUIRE_FALSE(writer.write(illegal));
+    }
+
+    loltaxx::GameReader reader;
+    REQUIRE(reader.open(path));
+    GameRecord game;
+    for (const auto& expected : written) {
+        REQUIRE(reader.next(&game));
+        REQUIRE(game.start.hash() == expected.start.hash());
+        REQUIRE(game.start.gaps() == expected.start.gaps());
+        REQUIRE(game.start.halfmoves() == expected.start.halfmoves());
+        REQUIRE(game.result == expected.result);
+        REQUIRE(game.moves == expected.moves);
+    }
+    REQUIRE_FALSE(reader.next(&game));
+    REQUIRE_FALSE(reader.failed());
+    reader.close();
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,99 @@
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+
+#include "catch2/catch.hpp"
+
+#include "app/nnue.h"
+#include "test/app/random_games.h"
+
+using loltaxx::Move;
+using loltaxx::Position;
+namespace nnue = loltaxx::nnue;
+
+namespace {
+
+void randomise_network(std::mt19937_64* rng) {
+    std::uniform_int_distribution<int> ft_weight{-64, 64};
+    std::uniform_int_distribution<int> weight{-128, 127};
+    for (auto& row : nnue::network.ft_weights) {
+        for (auto& value : row) {
+            value = std::int16_t(ft_weight(*rng));
+        }
+    }
+    for (auto& value : nnue::network.ft_biases) {
+        value = std::int16_t(ft_weight(*rng));
+    }
+    for (auto& row : nnue::network.l1_weights) {
+        for (auto& value : row) {
+            value = std::int8_t(weight(*rng));
+        }
+    }
+    for (auto& row : nnue::network.l2_weights) {
+        for (auto& value : row) {
+            value = std::int8_t(weight(*rng));
+        }
+    }
+    for (auto& value : nnue::network.out_weights) {
+        value = std::int8_t(weight(*rng));
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Vectorised dot product matches the scalar one", "[NNUE]") {
+    std::mt19937_64 rng{3};
+    alignas(64) std::uint8_t input[256];
+    alignas(64) std::int8_t weights[256];
+    for (int size : {32, 64, 96, 256}) {
+        for (int i = 0; i < size; ++i) {
+            input[i] = std::uint8_t(rng() % (nnue::FT_CLIP + 1));
+            weights[i] = std::int8_t(rng() % 256);
+        }
+        REQUIRE(nnue::dot(input, weights, size) == nnue::dot_scalar(input, weights, size));
+    }
+}
+
+TEST_CASE("Incremental accumulator updates match a refresh", "[NNUE]") {
+    std::mt19937_64 rng{11};
+    randomise_network(&rng);
+
+    random_games(11, [](const Position& pos, Move move) {
+        nnue::Accumulator acc;
+        nnue::refresh(pos, &acc);
+        nnue::Accumulator child;
+        if (pos.side_to_move() == loltaxx::constants::CROSS) {
+            nnue::update<loltaxx::Piece::Value::CROSS>(pos, move, acc, &child);
+        } else {
+            nnue::update<loltaxx::Piece::Value::KNOT>(pos, move, acc, &child);
+        }
+
+        Position next = pos;
+        next.make_move(move);
+        nnue::refresh(next, &acc);
+        REQUIRE(std::memcmp(&acc, &child, sizeof(nnue::Accumulator)) == 0);
+    });
+}
+
+TEST_CASE("Networks survive a write and load", "[NNUE]") {
+    std::mt19937_64 rng{5};
+    randomise_network(&rng);
+    Position pos{"x4oo/1x5/1x5/3o1oo/4o2/3o3/4o2 x 2 1"};
+    nnue::Accumulator acc;
+    nnue::refresh(pos, &acc);
+    int score = nnue::evaluate(acc, pos.side_to_move());
+
+    std::string path = std::filesystem::temp_directory_path() / "loltaxx_nnue_test.bin";
+    REQUIRE(nnue::write(path));
+    randomise_network(&rng);
+    REQUIRE(nnue::load(path));
+    REQUIRE(nnue::loaded());
+    nnue::refresh(pos, &acc);
+    REQUIRE(nnue::evaluate(acc, pos.side_to_move()) == score);
+
+    REQUIRE(!nnue::load(std::filesystem::temp_directory_path() / "loltaxx_missing_network.bin"));
+    nnue::unload();
+    REQUIRE(!nnue::loaded());
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch2/catch.hpp"
+
+#include "app/packed_position.h"
+
+using loltaxx::MoveList;
+using loltaxx::PackedPosition;
+using loltaxx::Position;
+
+TEST_CASE("Packed positions unpack to the same position", "[PackedPosition]") {
+    std::mt19937_64 rng{19};
+    for (const char* fen :
+         {"x5o/7/7/7/7/7/o5x x 0 1", "x-1-1-o/x3ooo/-x-1-1-/7/-1-1-1-/5x1/o-1-1-x x 0 1"}) {
+        Position pos{fen};
+        for (int ply = 0; ply < 200; ++ply) {
+            MoveList move_list = pos.legal_moves();
+            if (move_list.empty()) {
+                break;
+            }
+            pos.make_move(move_list[int(rng() % move_list.size())]);
+
+            int score = int(rng() % 80001) - 40000;
+            auto packed = PackedPosition::pack(pos, score, PackedPosition::DRAW);
+            Position unpacked = packed.position();
+            REQUIRE(unpacked.pieces(loltaxx::constants::CROSS) ==
+                    pos.pieces(loltaxx::constants::CROSS));
+            REQUIRE(unpacked.pieces(loltaxx::constants::KNOT) ==
+                    pos.pieces(loltaxx::constants::KNOT));
+            REQUIRE(unpacked.gaps() == pos.gaps());
+            REQUIRE(unpacked.side_to_move() == pos.side_to_move());
+            REQUIRE(unpacked.halfmoves() == std::min(pos.halfmoves(), 127));
+            REQUIRE(unpacked.hash() == pos.hash());
+            REQUIRE(packed.score == std::clamp(score, -PackedPosition::MAX_SCORE,
+                                               PackedPosition::MAX_SCORE));
+            REQUIRE(packed.result == PackedPosition::DRAW);
+        }
+    }
+}
+
+TEST_CASE("Packed positions survive the buffered writer and the mapped reader",
+          "[PackedPosition]") {
+    std::vector<PackedPosition> written;
+    Position pos{"x5o/7/2-1-2/7/2-1-2/7/o5x x 0 1"};
+    for (int i = 0; i < loltaxx::PackedWriter::BUFFER_SIZE + 100; ++i) {
+        written.push_back(PackedPosition::pack(pos, i % 1000, PackedPosition::CROSS_WIN));
+    }
+
+    std::string path = std::filesystem::temp_directory_path() / "loltaxx_packed_test.bin";
+    {
+        loltaxx::PackedWriter writer;
+        REQUIRE(writer.open(path));
+        REQUIRE(writer.write(written.data(), written.size()));
+    }
+
+    loltaxx::PackedReader reader;
+    REQUIRE(reader.open(path));
+    REQUIRE(reader.size() == written.size());
+    for (std::size_t i = 0; i < written.size(); ++i) {
+        REQUIRE(std::memcmp(&reader[i], &written[i], sizeof(PackedPosition)) == 0);
+    }
+    reader.close();
+    std::filesystem::remove(path);
+}
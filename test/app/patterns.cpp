@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+
+#include "catch2/catch.hpp"
+
+#include "app/patterns.h"
+#include "test/app/random_games.h"
+
+using loltaxx::Move;
+using loltaxx::Position;
+namespace patterns = loltaxx::patterns;
+
+TEST_CASE("Pattern tables cover the board", "[Patterns]") {
+    REQUIRE(patterns::NUM_WEIGHTS == 16 * 2187 + 4 * 19683);
+    for (const auto& square_patterns : patterns::SQUARE_PATTERNS) {
+        // A row and a column at least, and at most a diagonal each way and a corner on top
+        REQUIRE(square_patterns.size >= 2);
+        REQUIRE(square_patterns.size <= patterns::MAX_PATTERNS_PER_SQUARE);
+    }
+}
+
+TEST_CASE("Incremental pattern indices match a refresh", "[Patterns]") {
+    random_games(13, [](const Position& pos, Move move) {
+        patterns::Indices indices;
+        patterns::refresh(pos, &indices);
+        patterns::Indices child;
+        if (pos.side_to_move() == loltaxx::constants::CROSS) {
+            patterns::update<loltaxx::Piece::Value::CROSS>(pos, move, indices, &child);
+        } else {
+            patterns::update<loltaxx::Piece::Value::KNOT>(pos, move, indices, &child);
+        }
+
+        Position next = pos;
+        next.make_move(move);
+        patterns::refresh(next, &indices);
+        REQUIRE(std::memcmp(&indices, &child, sizeof(patterns::Indices)) == 0);
+    });
+}
+
+TEST_CASE("Portable pext matches the BMI2 instruction", "[Patterns]") {
+    std::mt19937_64 rng{19};
+    for (std::uint64_t mask : patterns::MASKS) {
+        for (int i = 0; i < 1000; ++i) {
+            std::uint64_t value = rng();
+            std::uint64_t expected = 0;
+            int digit = 0;
+            for (int sq = 0; sq < 64; ++sq) {
+                if (mask & (std::uint64_t(1) << sq)) {
+                    expected |= ((value >> sq) & 1) << digit++;
+                }
+            }
+            REQUIRE(patterns::pext_portable(value, mask) == expected);
+#if defined(__BMI2__)
+            REQUIRE(patterns::pext_portable(value, mask) == _pext_u64(value, mask));
+#endif
+        }
+    }
+}
+
+TEST_CASE("Pattern weights survive a write and load", "[Patterns]") {
+    std::mt19937_64 rng{17};
+    for (auto& weight : patterns::weights) {
+        weight = std::int16_t(rng() % 201) - 100;
+    }
+    Position pos{"x4oo/1x5/1x5/3o1oo/4o2/3o3/4o2 x 2 1"};
+    patterns::Indices indices;
+    patterns::refresh(pos, &indices);
+    int score = patterns::evaluate(indices, pos.side_to_move());
+
+    std::string path = std::filesystem::temp_directory_path() / "loltaxx_patterns_test.bin";
+    REQUIRE(patterns::write(path));
+    std::fill(std::begin(patterns::weights), std::end(patterns::weights), 0);
+    REQUIRE(patterns::load(path));
+    REQUIRE(patterns::loaded());
+    REQUIRE(patterns::evaluate(indices, pos.side_to_move()) == score);
+    REQUIRE(patterns::evaluate(indices, loltaxx::constants::KNOT) == -score);
+
+    REQUIRE(!patterns::load(std::filesystem::temp_directory_path() /
+                            "loltaxx_missing_patterns.bin"));
+    patterns::unload();
+    REQUIRE(!patterns::loaded());
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,12 @@
+#include "catch2/catch.hpp"
+
+#include "app/position.h"
+
+using loltaxx::Position;
+
+TEST_CASE("Positions write the FEN they are read from", "[Position]") {
+    for (const char* fen :
+         {"x5o/7/7/7/7/7/o5x x 0", "x-1-1-o/x3ooo/-x-1-1-/7/-1-1-1-/5x1/o-1-1-x o 37"}) {
+        REQUIRE(Position{fen}.fen() == fen);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef LOLTAXX_TEST_RANDOM_GAMES_H
+#define LOLTAXX_TEST_RANDOM_GAMES_H
+
+#include <cstdint>
+#include <random>
+
+#include "app/position.h"
+
+// Plays random games from the start position with and without gaps, calling visit with every
+// position and the move about to be made from it
+template <class Visit>
+void random_games(std::uint64_t seed, Visit visit) {
+    std::mt19937_64 rng{seed};
+    for (const char* fen : {"x5o/7/7/7/7/7/o5x x 0 1", "x5o/7/2-1-2/7/2-1-2/7/o5x x 0 1"}) {
+        loltaxx::Position pos{fen};
+        for (int ply = 0; ply < 200; ++ply) {
+            loltaxx::MoveList move_list = pos.legal_moves();
+            if (move_list.empty()) {
+                break;
+            }
+            loltaxx::Move move = move_list[int(rng() % move_list.size())];
+            visit(pos, move);
+            pos.make_move(move);
+        }
+    }
+}
+
+#endif  // LOLTAXX_TEST_RANDOM_GAMES_H
@@ -0,0 +1,101 @@
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch.hpp"
+
+#include "app/bench.h"
+#include "app/search.h"
+#include "app/tt.h"
+
+using loltaxx::MoveList;
+using loltaxx::Position;
+using loltaxx::UAIGoParameters;
+
+namespace {
+
+// Catch2 assertions are not thread-safe, searches run on other threads only collect results
+struct Result {
+    std::optional<loltaxx::Move> best_move;
+    int score;
+    MoveList pv;
+};
+
+std::vector<Result> search_all(
+    const std::vector<std::string>& fens,
+    const std::function<void(loltaxx::search::SearchGlobals&)>& configure = {}) {
+    TranspositionTable tt{1};
+    auto search_globals = loltaxx::search::SearchGlobals::new_search_globals();
+    search_globals.set_tt(&tt);
+    search_globals.set_verbose(false);
+    search_globals.set_go_parameters(
+        UAIGoParameters{{}, {}, 5, {}, {}, {}, {}, {}, false, false, {}});
+    if (configure) {
+        configure(search_globals);
+    }
+
+    std::vector<Result> results;
+    for (const auto& fen : fens) {
+        tt.clear();
+        auto best_move = loltaxx::search::best_move_search(Position{fen}, &search_globals);
+        results.push_back(Result{best_move, search_globals.score(), search_globals.pv()});
+    }
+    return results;
+}
+
+}  // namespace
+
+TEST_CASE("Searches with tables of their own run side by side", "[Search]") {
+    std::vector<std::string> fens{"x5o/7/7/7/7/7/o5x x 0 1",
+                                  "x4oo/1x5/1x5/3o1oo/4o2/3o3/4o2 x 2 1",
+                                  "x5o/5o1/2-1-2/7/2-1-2/7/o4xx x 0 1",
+                                  "1-1-1-x/x2ooox/-x-o-o-/2xxx1o/-1-1-x-/3xox1/o-x-o-o o 4 1"};
+    std::vector<Result> expected = search_all(fens);
+    for (const auto& result : expected) {
+        REQUIRE(result.best_move);
+        REQUIRE(result.pv[0] == *result.best_move);
+    }
+
+    std::vector<std::vector<Result>> results(2);
+    std::vector<std::thread> threads;
+    for (auto& result : results) {
+        threads.emplace_back([&fens, &result]() { result = search_all(fens); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& result : results) {
+        for (std::size_t i = 0; i < fens.size(); ++i) {
+            REQUIRE(result[i].best_move == expected[i].best_move);
+            REQUIRE(result[i].score == expected[i].score);
+            REQUIRE(result[i].pv.size() == expected[i].pv.size());
+            for (int ply = 0; ply < expected[i].pv.size(); ++ply) {
+                REQUIRE(result[i].pv[ply] == expected[i].pv[ply]);
+            }
+        }
+    }
+}
+
+// The pruning rules depend on the window, so only the full-width search has one score for both
+// drivers to find
+TEST_CASE("MTD(f) and PVS agree at a fixed depth", "[Search]") {
+    auto full_width = [](loltaxx::search::SearchDriver driver) {
+        return [driver](loltaxx::search::SearchGlobals& search_globals) {
+            search_globals.set_driver(driver);
+            search_globals.set_null_move_pruning(false);
+            search_globals.set_late_move_reductions(false);
+            search_globals.set_reverse_futility_pruning(false);
+        };
+    };
+    const auto& fens = loltaxx::bench::BENCH_FENS;
+    std::vector<Result> pvs = search_all(fens, full_width(loltaxx::search::SearchDriver::PVS));
+    std::vector<Result> mtdf = search_all(fens, full_width(loltaxx::search::SearchDriver::MTDF));
+    for (std::size_t i = 0; i < fens.size(); ++i) {
+        INFO(fens[i]);
+        CHECK(mtdf[i].score == pvs[i].score);
+        CHECK(mtdf[i].best_move == pvs[i].best_move);
+    }
+}
@@ -0,0 +1,90 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "catch2/catch.hpp"
+
+#include "app/search.h"
+
+using loltaxx::MoveList;
+using loltaxx::Position;
+using loltaxx::UAIGoParameters;
+
+namespace {
+
+std::atomic<bool> counting{false};
+std::atomic<std::uint64_t> allocations{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    if (counting) {
+        ++allocations;
+    }
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+template <class F>
+std::uint64_t count_allocations(F function) {
+    allocations = 0;
+    counting = true;
+    function();
+    counting = false;
+    return allocations;
+}
+
+TEST_CASE("Move generation does not allocate", "[Search]") {
+    Position pos{"x5o/7/2-1-2/7/2-1-2/7/o5x x 0 1"};
+    std::uint64_t count = count_allocations([&pos]() {
+        for (int i = 0; i < 64; ++i) {
+            MoveList move_list = pos.legal_moves();
+            if (move_list.empty()) {
+                break;
+            }
+            pos.make_move(move_list[i % move_list.size()]);
+        }
+    });
+    REQUIRE(count == 0);
+}
+
+TEST_CASE("Fixed depth search does not allocate", "[Search]") {
+    loltaxx::search::SearchGlobals search_globals =
+        loltaxx::search::SearchGlobals::new_search_globals();
+    search_globals.set_verbose(false);
+    search_globals.set_go_parameters(
+        UAIGoParameters{{}, {}, 6, {}, {}, {}, {}, {}, false, false, {}});
+    Position pos{"x5o/7/7/7/7/7/o5x x 0 1"};
+
+    std::optional<loltaxx::Move> best_move;
+    std::uint64_t count = count_allocations(
+        [&]() { best_move = loltaxx::search::best_move_search(pos, &search_globals); });
+    REQUIRE(count == 0);
+    REQUIRE(best_move);
+}
+
+TEST_CASE("MultiPV search does not allocate", "[Search]") {
+    loltaxx::search::SearchGlobals search_globals =
+        loltaxx::search::SearchGlobals::new_search_globals();
+    search_globals.set_verbose(false);
+    search_globals.set_multipv(4);
+    search_globals.set_go_parameters(
+        UAIGoParameters{{}, {}, 5, {}, {}, {}, {}, {}, false, false, {}});
+    Position pos{"x4oo/5o1/6x/7/3x3/2x4/7 x 0 1"};
+
+    std::optional<loltaxx::Move> best_move;
+    std::uint64_t count = count_allocations(
+        [&]() { best_move = loltaxx::search::best_move_search(pos, &search_globals); });
+    REQUIRE(count == 0);
+    REQUIRE(best_move);
+}
@@ -0,0 +1,44 @@
+#include <filesystem>
+#include <string>
+
+#include "catch2/catch.hpp"
+
+#include "app/tablebase.h"
+
+using loltaxx::Position;
+using loltaxx::Tablebase;
+
+namespace {
+
+const std::string LAYOUT = "-------/-------/-------/-------/3----/3----/3----";
+
+}  // namespace
+
+TEST_CASE("Tablebase results survive a write and load", "[Tablebase]") {
+    auto gaps = Position{LAYOUT + " x 0"}.gaps();
+    auto table = Tablebase::generate(gaps, 2);
+    REQUIRE(table.size() == Tablebase::num_entries(9));
+
+    std::string path = std::filesystem::temp_directory_path() / "loltaxx_tablebase_test.tb";
+    REQUIRE(Tablebase::write(path, gaps, table));
+
+    Tablebase tablebase;
+    REQUIRE(tablebase.load(path));
+
+    // No pieces left for the side to move
+    auto lost = tablebase.probe(Position{"-------/-------/-------/-------/3----/3----/o2---- x 0"});
+    REQUIRE(lost);
+    REQUIRE(lost->result == Tablebase::LOSS);
+    REQUIRE(lost->distance == 0);
+
+    // Cloning next to the only knot captures it
+    auto won = tablebase.probe(Position{"-------/-------/-------/-------/x2----/3----/2o---- x 0"});
+    REQUIRE(won);
+    REQUIRE(won->result == Tablebase::WIN);
+    REQUIRE(won->distance == 1);
+
+    // Positions on other layouts are not in the table
+    REQUIRE(!tablebase.probe(Position{"x5o/7/7/7/7/7/o5x x 0"}));
+
+    std::filesystem::remove(path);
+}